@@ -0,0 +1,418 @@
+// Allocation shim: counts what malloc() and friends are asked to do and can make them fail on purpose.
+// It replaces the fake_malloc() trick from 11_1_Singly_Linked_Lists for all programs in this repository.
+//
+// Build it with `make` in this folder, then run any program with it preloaded, e.g.:
+//   LD_PRELOAD=../09_Dynamic_Memory_Management/liballocshim.so ./11_2_1_doubly-linked-lists
+// or link allocshim.o into a program (`make LDLIBS=../09_Dynamic_Memory_Management/allocshim.o`).
+// Programs built with -fsanitize=address bring their own malloc(); build them without it first.
+//
+// At exit a summary goes to stderr: number of allocations, frees and reallocs, bytes allocated, peak and leaked live
+// bytes (as malloc_usable_size() sees them), reallocs that had to copy, and the same per call site (the return
+// address into the caller; `addr2line -f -e <program> <offset>` turns `program+offset` into a function and line).
+//
+// Environment variables (all optional):
+//   ALLOCSHIM_FAIL_EVERY=n   every n-th allocation fails
+//   ALLOCSHIM_FAIL_AFTER=n   all allocations after the first n fail
+//   ALLOCSHIM_FAIL_RATE=p    p percent of allocations fail, chosen by a pseudo random sequence …
+//   ALLOCSHIM_SEED=s         … that starts from s (default 1), so a failing run can be repeated
+//   ALLOCSHIM_TOP=n          number of call sites in the summary (default 10; 0 turns the summary off)
+// Failing allocations are counted but don't change any other numbers.
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// glibc's own allocator; the shim sits in front of it
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t n, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void  __libc_free (void *ptr);
+
+#define MAX_SITES 4096 // power of 2
+
+typedef struct site
+{
+  void  *addr; // return address into the caller; NULL marks an unused entry
+  size_t allocs;
+  size_t bytes;
+  size_t realloc_copies;
+  size_t copied_bytes;
+} Site;
+
+typedef struct stats
+{
+  size_t allocs;
+  size_t frees;
+  size_t reallocs;
+  size_t realloc_copies;
+  size_t copied_bytes;
+  size_t bytes;
+  size_t live;
+  size_t peak;
+  size_t failures;
+  size_t lost_sites; // allocations not counted per site b/c the site table was full
+} Stats;
+
+static Stats       stats;
+static Site        sites[MAX_SITES];
+static atomic_flag lock = ATOMIC_FLAG_INIT;
+
+// configuration, from the environment
+static size_t   fail_every;
+static size_t   fail_after;
+static unsigned fail_rate;
+static unsigned seed = 1;
+static size_t   top  = 10;
+
+static void
+acquire (void)
+{
+  while (atomic_flag_test_and_set_explicit (&lock, memory_order_acquire))
+    ;
+}
+
+static void
+release (void)
+{
+  atomic_flag_clear_explicit (&lock, memory_order_release);
+}
+
+static size_t
+env_size (const char *name, size_t dflt)
+{
+  const char *s = getenv (name);
+  return s ? strtoull (s, NULL, 10) : dflt;
+}
+
+__attribute__ ((constructor)) static void
+init (void)
+{
+  fail_every = env_size ("ALLOCSHIM_FAIL_EVERY", 0);
+  fail_after = env_size ("ALLOCSHIM_FAIL_AFTER", 0);
+  fail_rate  = env_size ("ALLOCSHIM_FAIL_RATE", 0);
+  seed       = env_size ("ALLOCSHIM_SEED", 1);
+  top        = env_size ("ALLOCSHIM_TOP", 10);
+  seed       = seed ? seed : 1;
+}
+
+// Site entry for `addr`; open addressing with linear probing. Call with the lock held.
+static Site *
+find_site (void *addr)
+{
+  size_t i = ((uintptr_t)addr >> 2) * 0x9E3779B97F4A7C15ull >> 52 & (MAX_SITES - 1);
+  for (size_t probes = 0; probes < MAX_SITES; probes++, i = (i + 1) & (MAX_SITES - 1))
+    {
+      if (sites[i].addr == addr)
+        {
+          return &sites[i];
+        }
+      if (!sites[i].addr)
+        {
+          sites[i].addr = addr;
+          return &sites[i];
+        }
+    }
+  return NULL;
+}
+
+// Decides if the next allocation fails. Call with the lock held.
+static bool
+must_fail (void)
+{
+  size_t n = stats.allocs + stats.reallocs + stats.failures + 1; // number of this allocation
+  if (fail_every && n % fail_every == 0)
+    {
+      return true;
+    }
+  if (fail_after && n > fail_after)
+    {
+      return true;
+    }
+  if (fail_rate)
+    {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      return seed % 100 < fail_rate;
+    }
+  return false;
+}
+
+static void
+add_live (size_t size)
+{
+  stats.live += size;
+  if (stats.live > stats.peak)
+    {
+      stats.peak = stats.live;
+    }
+}
+
+// Check for an injected failure. Call with the lock held.
+static bool
+inject_failure (void)
+{
+  if (must_fail ())
+    {
+      stats.failures++;
+      errno = ENOMEM;
+      return true;
+    }
+  return false;
+}
+
+// Count a new block `p` of `size` bytes requested by `caller`.
+static void *
+count_alloc (void *p, size_t size, void *caller)
+{
+  if (p)
+    {
+      stats.allocs++;
+      stats.bytes += size;
+      add_live (malloc_usable_size (p));
+      Site *site = find_site (caller);
+      if (site)
+        {
+          site->allocs++;
+          site->bytes += size;
+        }
+      else
+        {
+          stats.lost_sites++;
+        }
+    }
+  return p;
+}
+
+static void *
+shim_alloc (size_t alignment, size_t n, size_t size, void *caller)
+{
+  acquire ();
+  if (inject_failure ())
+    {
+      release ();
+      return NULL;
+    }
+  release ();
+
+  void *p;
+  if (alignment)
+    {
+      p = __libc_memalign (alignment, size);
+    }
+  else if (n)
+    {
+      p = __libc_calloc (n, size);
+      size *= n;
+    }
+  else
+    {
+      p = __libc_malloc (size);
+    }
+
+  acquire ();
+  count_alloc (p, size, caller);
+  release ();
+  return p;
+}
+
+void *
+malloc (size_t size)
+{
+  return shim_alloc (0, 0, size, __builtin_return_address (0));
+}
+
+void *
+calloc (size_t n, size_t size)
+{
+  if (n == 0 || size == 0)
+    {
+      n    = 1;
+      size = 0;
+    }
+  return shim_alloc (0, n, size, __builtin_return_address (0));
+}
+
+void *
+aligned_alloc (size_t alignment, size_t size)
+{
+  return shim_alloc (alignment, 0, size, __builtin_return_address (0));
+}
+
+void *
+memalign (size_t alignment, size_t size)
+{
+  return shim_alloc (alignment, 0, size, __builtin_return_address (0));
+}
+
+int
+posix_memalign (void **ptr, size_t alignment, size_t size)
+{
+  void *p = shim_alloc (alignment, 0, size, __builtin_return_address (0));
+  if (!p)
+    {
+      return ENOMEM;
+    }
+  *ptr = p;
+  return 0;
+}
+
+void
+free (void *ptr)
+{
+  if (!ptr)
+    {
+      return;
+    }
+  size_t size = malloc_usable_size (ptr);
+  __libc_free (ptr);
+
+  acquire ();
+  stats.frees++;
+  stats.live -= size;
+  release ();
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  void *caller = __builtin_return_address (0);
+  if (!ptr)
+    {
+      return shim_alloc (0, 0, size, caller);
+    }
+  if (size == 0)
+    {
+      free (ptr);
+      return NULL;
+    }
+
+  acquire ();
+  if (inject_failure ())
+    {
+      release ();
+      return NULL;
+    }
+  release ();
+
+  size_t old_size = malloc_usable_size (ptr);
+  void  *p        = __libc_realloc (ptr, size);
+  if (!p)
+    {
+      return NULL;
+    }
+
+  acquire ();
+  stats.reallocs++;
+  stats.bytes += size;
+  stats.live -= old_size;
+  add_live (malloc_usable_size (p));
+  Site *site = find_site (caller);
+  if (p != ptr)
+    {
+      size_t copied = old_size < size ? old_size : size;
+      stats.realloc_copies++;
+      stats.copied_bytes += copied;
+      if (site)
+        {
+          site->realloc_copies++;
+          site->copied_bytes += copied;
+        }
+    }
+  if (site)
+    {
+      site->allocs++;
+      site->bytes += size;
+    }
+  else
+    {
+      stats.lost_sites++;
+    }
+  release ();
+  return p;
+}
+
+static int
+cmp_sites (const void *a, const void *b)
+{
+  const Site *x = a;
+  const Site *y = b;
+  return (x->bytes < y->bytes) - (x->bytes > y->bytes); // most bytes first
+}
+
+static void
+print_site (const Site *site)
+{
+  Dl_info info;
+  if (dladdr (site->addr, &info) && info.dli_fname)
+    {
+      const char *name = strrchr (info.dli_fname, '/');
+      name             = name ? name + 1 : info.dli_fname;
+      if (info.dli_sname)
+        {
+          fprintf (stderr, "  %s (%s+%#tx)", name, info.dli_sname, (char *)site->addr - (char *)info.dli_saddr);
+        }
+      else
+        {
+          fprintf (stderr, "  %s+%#tx", name, (char *)site->addr - (char *)info.dli_fbase);
+        }
+    }
+  else
+    {
+      fprintf (stderr, "  %p", site->addr);
+    }
+  fprintf (stderr, "\n      %zu allocs, %zu bytes, %zu realloc copies (%zu bytes)\n", site->allocs, site->bytes,
+           site->realloc_copies, site->copied_bytes);
+}
+
+__attribute__ ((destructor)) static void
+report (void)
+{
+  if (!top)
+    {
+      return;
+    }
+
+  // take a copy, so that allocations by stdio or dladdr() don't change the numbers while we print them
+  static Site copy[MAX_SITES];
+  acquire ();
+  Stats s = stats;
+  memcpy (copy, sites, sizeof sites);
+  release ();
+
+  size_t n = 0;
+  for (size_t i = 0; i < MAX_SITES; i++)
+    {
+      if (copy[i].addr && copy[i].allocs)
+        {
+          copy[n++] = copy[i];
+        }
+    }
+  qsort (copy, n, sizeof *copy, cmp_sites);
+
+  fprintf (stderr, "\n-------------------- allocation summary --------------------\n");
+  fprintf (stderr, "allocs %zu, frees %zu, reallocs %zu (%zu copied, %zu bytes)\n", s.allocs, s.frees, s.reallocs,
+           s.realloc_copies, s.copied_bytes);
+  fprintf (stderr, "bytes requested %zu, peak live %zu, live at exit %zu\n", s.bytes, s.peak, s.live);
+  if (s.failures)
+    {
+      fprintf (stderr, "injected failures %zu\n", s.failures);
+    }
+  if (s.lost_sites)
+    {
+      fprintf (stderr, "allocations without call site (table full) %zu\n", s.lost_sites);
+    }
+  fprintf (stderr, "top %zu of %zu call sites by bytes:\n", n < top ? n : top, n);
+  for (size_t i = 0; i < n && i < top; i++)
+    {
+      print_site (&copy[i]);
+    }
+}
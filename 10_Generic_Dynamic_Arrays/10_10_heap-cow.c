@@ -0,0 +1,254 @@
+// heap-allocated inlined arrays with reference counting and copy-on-write; compare with 10_6_heap-ref.c
+
+// `da_share` hands out another reference to the same block in O(1) (a snapshot).
+// Reading (`da_at`, `da_len`) never copies. Writing through `da_append` or `da_set` first checks the
+// reference count; if the block is shared, the writer gets its own copy and drops its reference to the old one.
+// The count is atomic, so snapshots can be passed to other threads.
+// Never write through `da_at` on an array that might be shared; use `da_set`.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+typedef struct da_meta
+{
+  size_t        size;
+  size_t        used;
+  atomic_size_t refs;
+} DaMeta;
+
+#define dynarr(TYPE)                                                                                                   \
+  struct                                                                                                               \
+  {                                                                                                                    \
+    DaMeta meta;                                                                                                       \
+    TYPE   data[];                                                                                                     \
+  }
+
+void *
+realloc_dynarray_mem (DaMeta *p, size_t meta_size, size_t obj_size, size_t new_len)
+{
+  if (((SIZE_MAX - meta_size) / obj_size < new_len))
+    {
+      goto fail; // is there a size overflow?
+    }
+  DaMeta *da = realloc (p, meta_size + obj_size * new_len);
+  if (!da)
+    {
+      goto fail;
+    }
+  da->size = new_len;
+  da->used = MIN (da->used, new_len);
+  return da;
+
+fail:
+  free (p); // always free if we cannot reallocate; only called on blocks we own exclusively
+  return NULL;
+}
+
+void *
+new_dynarray_mem (size_t meta_size, size_t obj_size, size_t len)
+{
+  DaMeta *array = realloc_dynarray_mem (NULL, meta_size, obj_size, len);
+  if (array)
+    {
+      array->used = 0;
+      atomic_init (&array->refs, 1);
+    }
+  return array;
+}
+
+void *
+grow_dynarray_mem (DaMeta *p, size_t meta_size, size_t obj_size)
+{
+  size_t used   = meta_size + obj_size * p->size;
+  size_t adding = MAX (1, p->size);
+  if ((SIZE_MAX - used) / obj_size < adding)
+    {
+      free (p);
+      return NULL;
+    }
+  return realloc_dynarray_mem (p, meta_size, obj_size, p->size + adding);
+}
+
+// Drop one reference; the last one frees the block.
+void
+release_dynarray_mem (DaMeta *p)
+{
+  if (p && atomic_fetch_sub_explicit (&p->refs, 1, memory_order_acq_rel) == 1)
+    {
+      free (p);
+    }
+}
+
+// Returns a block that only the caller references: `p` itself if it isn't shared, otherwise a fresh copy.
+// The caller's reference to `p` is consumed either way. Returns NULL if the copy cannot be allocated.
+void *
+unshare_dynarray_mem (DaMeta *p, size_t meta_size, size_t obj_size)
+{
+  if (atomic_load_explicit (&p->refs, memory_order_acquire) == 1)
+    {
+      return p;
+    }
+
+  DaMeta *copy = new_dynarray_mem (meta_size, obj_size, p->size);
+  if (copy)
+    {
+      memcpy ((char *)copy + meta_size, (char *)p + meta_size, obj_size * p->used);
+      copy->used = p->used;
+    }
+  release_dynarray_mem (p);
+  return copy;
+}
+
+#define da_data_offset(da) ((char *)&(da)->data - (char *)(da)) /* size of DaMeta */
+#define da_at(da, i)       (da->data[(i)])
+#define da_len(da)         (da->meta.used)
+#define da_refs(da)        atomic_load (&(da)->meta.refs)
+#define new_da(da, init_size)                                                                                          \
+  ((da) = NULL, new_dynarray_mem (da_data_offset (da), sizeof *(da)->data, (init_size))) /* using comma-operator */
+
+// O(1) snapshot: another reference to the same memory
+#define da_share(da) (atomic_fetch_add_explicit (&(da)->meta.refs, 1, memory_order_relaxed), (da))
+
+#define da_free(da)                                                                                                    \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      release_dynarray_mem ((DaMeta *)(da));                                                                           \
+      (da) = NULL;                                                                                                     \
+    }                                                                                                                  \
+  while (0)
+
+#define da_unshare(da) ((da) = unshare_dynarray_mem ((DaMeta *)(da), da_data_offset (da), sizeof *(da)->data))
+
+#define da_append(da, ...)                                                                                             \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      if (!da_unshare (da))                                                                                            \
+        break;                                                                                                         \
+      if ((da)->meta.used == (da)->meta.size)                                                                          \
+        {                                                                                                              \
+          (da) = grow_dynarray_mem ((DaMeta *)(da), da_data_offset (da), sizeof *(da)->data);                          \
+          if (!(da))                                                                                                   \
+            break;                                                                                                     \
+        }                                                                                                              \
+      (da)->data[(da)->meta.used++] = __VA_ARGS__;                                                                     \
+    }                                                                                                                  \
+  while (0)
+
+#define da_set(da, i, ...)                                                                                             \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      assert ((i) < da_len (da));                                                                                      \
+      if (!da_unshare (da))                                                                                            \
+        break;                                                                                                         \
+      (da)->data[(i)] = __VA_ARGS__;                                                                                   \
+    }                                                                                                                  \
+  while (0)
+
+// =============== Point ==================================================
+typedef struct
+{
+  double x, y;
+} point;
+
+typedef dynarr (point) point_array;
+
+void
+print_points (const char *name, point_array *da)
+{
+  printf ("%s (%zu refs): ", name, da_refs (da));
+  for (size_t i = 0; i < da_len (da); i++)
+    {
+      printf ("<%.1f,%.1f> ", da_at (da, i).x, da_at (da, i).y);
+    }
+  putchar ('\n');
+}
+
+// A pipeline stage that runs in its own thread; it owns the snapshot it is handed.
+void *
+sum_stage (void *arg)
+{
+  point_array *snapshot = arg;
+  double      *sum      = malloc (sizeof *sum);
+  if (sum)
+    {
+      *sum = 0.0;
+      for (size_t i = 0; i < da_len (snapshot); i++)
+        {
+          *sum += da_at (snapshot, i).x + da_at (snapshot, i).y;
+        }
+    }
+  da_free (snapshot);
+  return sum;
+}
+
+// =============== End Point ==============================================
+
+int
+main ()
+{
+  point_array *points = new_da (points, 0);
+  if (!points)
+    {
+      goto error;
+    }
+
+  for (int i = 0; i < 4; i++)
+    {
+      da_append (points, (point){ .x = i, .y = 4 - i });
+      if (!points)
+        {
+          goto error;
+        }
+    }
+
+  // O(1) handoff; both names refer to the same memory until one of them writes
+  point_array *snapshot = da_share (points);
+  print_points ("points  ", points);
+  print_points ("snapshot", snapshot);
+
+  da_set (points, 0, (point){ .x = -1.0, .y = -1.0 }); // copies, since the block is shared
+  if (!points)
+    {
+      da_free (snapshot);
+      goto error;
+    }
+  print_points ("points  ", points);
+  print_points ("snapshot", snapshot);
+
+  // hand a second snapshot to another thread while we keep appending to our own copy
+  pthread_t worker;
+  if (pthread_create (&worker, NULL, sum_stage, da_share (snapshot)) != 0)
+    {
+      release_dynarray_mem ((DaMeta *)snapshot); // the reference we made for the worker
+      da_free (snapshot);
+      goto error;
+    }
+  da_append (snapshot, (point){ .x = 10.0, .y = 10.0 }); // copies if the worker still holds its reference
+  void *result;
+  pthread_join (worker, &result);
+  if (!snapshot || !result)
+    {
+      free (result);
+      da_free (snapshot);
+      goto error;
+    }
+  printf ("worker sum: %.1f\n", *(double *)result);
+  free (result);
+  print_points ("snapshot", snapshot);
+
+  da_free (snapshot);
+  da_free (points);
+  return 0;
+
+error:
+  da_free (points);
+  return 1;
+}
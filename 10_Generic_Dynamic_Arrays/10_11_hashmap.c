@@ -0,0 +1,615 @@
+// Generate an open-addressing hash map using macros (in the style of 10_3_code-generation.c).
+
+// Robin Hood hashing: every slot has a control byte that is 0 for an empty slot and otherwise holds the entry's
+// distance from its home slot plus one. On insertion an entry that is closer to its home than the one being placed
+// gives up its slot ("rob the rich"), so probe sequences stay short and a lookup can stop as soon as it sees an
+// entry that is closer to home than it would be. Keys are only compared when the distances match, i.e., when the
+// slot holds an entry with the same home.
+//
+// Deletion shifts the following entries one slot back instead of leaving a tombstone.
+//
+// When the table gets full, a twice as large table is allocated and its slots are moved over a few at a time by
+// the following insert/remove calls (lookups check both tables), so no single call pays for the whole rehash.
+// `reserve` is the exception; it sizes the table up front in one go.
+//
+// Build with optimizations for the benchmark: make CFLAGS=-O3 10_11_hashmap
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/param.h>
+#include <time.h>
+
+#define size_check(n, type)     ((SIZE_MAX / sizeof (type)) >= (n))
+#define checked_malloc(n, type) (size_check ((n), (type)) ? malloc ((n) * sizeof (type)) : NULL)
+#define HM_MIN_CAPACITY         16        // must be a power of two
+#define HM_MAX_CTRL             UINT8_MAX // largest distance + 1 a control byte can hold
+#define HM_MIGRATE_STEP         8         // slots of the old table migrated per insert/remove
+#define hm_too_full(used, cap)  ((used) * 8 > (cap) * 7) // max load factor 7/8
+
+// -------------------- Macro Definitions ---------------------------------------------------------------------------
+
+#define GEN_HASHMAP_DECLARATIONS(KEY, VALUE)                                                                           \
+  typedef struct hm_##KEY##_##VALUE##_entry                                                                            \
+  {                                                                                                                    \
+    KEY   key;                                                                                                         \
+    VALUE value;                                                                                                       \
+  } hm_##KEY##_##VALUE##_entry;                                                                                        \
+                                                                                                                       \
+  typedef struct hm_##KEY##_##VALUE##_table                                                                            \
+  {                                                                                                                    \
+    size_t                       cap; /* 0 or a power of two */                                                        \
+    size_t                       used;                                                                                 \
+    uint8_t                     *ctrl;                                                                                 \
+    hm_##KEY##_##VALUE##_entry *entries;                                                                               \
+  } hm_##KEY##_##VALUE##_table;                                                                                        \
+                                                                                                                       \
+  typedef struct hashmap_##KEY##_##VALUE                                                                               \
+  {                                                                                                                    \
+    hm_##KEY##_##VALUE##_table cur;                                                                                    \
+    hm_##KEY##_##VALUE##_table old;         /* being migrated into cur */                                              \
+    size_t                     migrate_pos; /* next slot of old to look at */                                          \
+  } hashmap_##KEY##_##VALUE;                                                                                           \
+                                                                                                                       \
+  void   hm_##KEY##_##VALUE##_init (hashmap_##KEY##_##VALUE *hm);                                                      \
+  void   hm_##KEY##_##VALUE##_dealloc (hashmap_##KEY##_##VALUE *hm);                                                   \
+  bool   hm_##KEY##_##VALUE##_reserve (hashmap_##KEY##_##VALUE *hm, size_t n);                                         \
+  bool   hm_##KEY##_##VALUE##_insert (hashmap_##KEY##_##VALUE *hm, KEY key, VALUE value);                              \
+  VALUE *hm_##KEY##_##VALUE##_lookup (hashmap_##KEY##_##VALUE *hm, KEY key);                                           \
+  bool   hm_##KEY##_##VALUE##_remove (hashmap_##KEY##_##VALUE *hm, KEY key);                                           \
+  size_t hm_##KEY##_##VALUE##_len (hashmap_##KEY##_##VALUE *hm);
+
+#define GEN_HASHMAP_IMPLEMENTATIONS(KEY, VALUE, HASH, EQ)                                                              \
+  /* ---------- single tables ---------- */                                                                            \
+                                                                                                                       \
+  bool hm_##KEY##_##VALUE##_table_init (hm_##KEY##_##VALUE##_table *t, size_t cap)                                     \
+  {                                                                                                                    \
+    t->ctrl    = calloc (cap, sizeof *t->ctrl);                                                                        \
+    t->entries = checked_malloc (cap, *t->entries);                                                                    \
+    if (!t->ctrl || !t->entries)                                                                                       \
+      {                                                                                                                \
+        free (t->ctrl);                                                                                                \
+        free (t->entries);                                                                                             \
+        *t    = (hm_##KEY##_##VALUE##_table){ 0 };                                                                     \
+        errno = ENOMEM;                                                                                                \
+        return false;                                                                                                  \
+      }                                                                                                                \
+    t->cap  = cap;                                                                                                     \
+    t->used = 0;                                                                                                       \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  void hm_##KEY##_##VALUE##_table_free (hm_##KEY##_##VALUE##_table *t)                                                 \
+  {                                                                                                                    \
+    free (t->ctrl);                                                                                                    \
+    free (t->entries);                                                                                                 \
+    *t = (hm_##KEY##_##VALUE##_table){ 0 };                                                                            \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* index of key or t->cap if it is not in the table */                                                               \
+  size_t hm_##KEY##_##VALUE##_table_find (hm_##KEY##_##VALUE##_table *t, KEY key, size_t h)                            \
+  {                                                                                                                    \
+    if (!t->used)                                                                                                      \
+      return t->cap;                                                                                                   \
+    size_t   mask = t->cap - 1;                                                                                        \
+    size_t   i    = h & mask;                                                                                          \
+    unsigned d    = 1;                                                                                                 \
+    while (t->ctrl[i] >= d)                                                                                            \
+      {                                                                                                                \
+        if (t->ctrl[i] == d && EQ (t->entries[i].key, key))                                                            \
+          return i;                                                                                                    \
+        i = (i + 1) & mask;                                                                                            \
+        d++;                                                                                                           \
+      }                                                                                                                \
+    return t->cap;                                                                                                     \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* Checks that inserting with hash h fits into the control bytes. Every entry we displace moves at most as far as */ \
+  /* the first empty slot, so its new distance is bounded by its old distance plus the remaining walk. */              \
+  bool hm_##KEY##_##VALUE##_table_can_put (hm_##KEY##_##VALUE##_table *t, size_t h)                                    \
+  {                                                                                                                    \
+    size_t mask  = t->cap - 1;                                                                                         \
+    size_t i     = h & mask;                                                                                           \
+    size_t k     = 0;                                                                                                  \
+    size_t worst = 1; /* max over the walk of ctrl - k, for us 1 - 0 */                                                \
+    while (t->ctrl[i])                                                                                                 \
+      {                                                                                                                \
+        if (t->ctrl[i] > k && t->ctrl[i] - k > worst)                                                                  \
+          worst = t->ctrl[i] - k;                                                                                      \
+        i = (i + 1) & mask;                                                                                            \
+        if (++k >= HM_MAX_CTRL)                                                                                        \
+          return false;                                                                                                \
+      }                                                                                                                \
+    return worst + k <= HM_MAX_CTRL;                                                                                   \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* key must not be in the table and table_can_put() must have said yes */                                            \
+  void hm_##KEY##_##VALUE##_table_put (hm_##KEY##_##VALUE##_table *t, hm_##KEY##_##VALUE##_entry e, size_t h)          \
+  {                                                                                                                    \
+    size_t  mask = t->cap - 1;                                                                                         \
+    size_t  i    = h & mask;                                                                                           \
+    uint8_t d    = 1;                                                                                                  \
+    while (t->ctrl[i])                                                                                                 \
+      {                                                                                                                \
+        if (t->ctrl[i] < d)                                                                                            \
+          {                                                                                                            \
+            uint8_t                    tmp_d = t->ctrl[i];                                                             \
+            hm_##KEY##_##VALUE##_entry tmp_e = t->entries[i];                                                          \
+            t->ctrl[i]                       = d;                                                                      \
+            t->entries[i]                    = e;                                                                      \
+            d                                = tmp_d;                                                                  \
+            e                                = tmp_e;                                                                  \
+          }                                                                                                            \
+        i = (i + 1) & mask;                                                                                            \
+        d++;                                                                                                           \
+      }                                                                                                                \
+    t->ctrl[i]    = d;                                                                                                 \
+    t->entries[i] = e;                                                                                                 \
+    t->used++;                                                                                                         \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* backward-shift deletion: no tombstones */                                                                         \
+  void hm_##KEY##_##VALUE##_table_erase_at (hm_##KEY##_##VALUE##_table *t, size_t i)                                   \
+  {                                                                                                                    \
+    size_t mask = t->cap - 1;                                                                                          \
+    size_t j    = (i + 1) & mask;                                                                                      \
+    while (t->ctrl[j] > 1)                                                                                             \
+      {                                                                                                                \
+        t->ctrl[i]    = t->ctrl[j] - 1;                                                                                \
+        t->entries[i] = t->entries[j];                                                                                 \
+        i             = j;                                                                                             \
+        j             = (j + 1) & mask;                                                                                \
+      }                                                                                                                \
+    t->ctrl[i] = 0;                                                                                                    \
+    t->used--;                                                                                                         \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* ---------- the map: cur plus the old table that is being migrated ---------- */                                   \
+                                                                                                                       \
+  void hm_##KEY##_##VALUE##_init (hashmap_##KEY##_##VALUE *hm)                                                         \
+  {                                                                                                                    \
+    *hm = (hashmap_##KEY##_##VALUE){ 0 };                                                                              \
+  }                                                                                                                    \
+                                                                                                                       \
+  void hm_##KEY##_##VALUE##_dealloc (hashmap_##KEY##_##VALUE *hm)                                                      \
+  {                                                                                                                    \
+    hm_##KEY##_##VALUE##_table_free (&hm->cur);                                                                        \
+    hm_##KEY##_##VALUE##_table_free (&hm->old);                                                                        \
+    hm->migrate_pos = 0;                                                                                               \
+  }                                                                                                                    \
+                                                                                                                       \
+  size_t hm_##KEY##_##VALUE##_len (hashmap_##KEY##_##VALUE *hm)                                                        \
+  {                                                                                                                    \
+    return hm->cur.used + hm->old.used;                                                                                \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* Copy everything into a single new table of at least cap slots (synchronous). */                                   \
+  /* The old tables are only freed once the copy succeeded, so failure leaves the map unchanged. */                    \
+  bool hm_##KEY##_##VALUE##_rebuild (hashmap_##KEY##_##VALUE *hm, size_t cap)                                          \
+  {                                                                                                                    \
+    hm_##KEY##_##VALUE##_table  t;                                                                                     \
+    hm_##KEY##_##VALUE##_table *src[] = { &hm->cur, &hm->old };                                                        \
+  retry:                                                                                                               \
+    if (!hm_##KEY##_##VALUE##_table_init (&t, cap))                                                                    \
+      return false;                                                                                                    \
+    for (int s = 0; s < 2; s++)                                                                                        \
+      {                                                                                                                \
+        for (size_t i = 0; i < src[s]->cap; i++)                                                                       \
+          {                                                                                                            \
+            if (!src[s]->ctrl[i])                                                                                      \
+              continue;                                                                                                \
+            size_t h = HASH (src[s]->entries[i].key);                                                                  \
+            if (!hm_##KEY##_##VALUE##_table_can_put (&t, h))                                                           \
+              {                                                                                                        \
+                hm_##KEY##_##VALUE##_table_free (&t);                                                                  \
+                if (cap > SIZE_MAX / 2 || cap / 64 > hm_##KEY##_##VALUE##_len (hm))                                    \
+                  {                                                                                                    \
+                    errno = EOVERFLOW; /* the hash function puts too many keys into the same slots */                  \
+                    return false;                                                                                      \
+                  }                                                                                                    \
+                cap *= 2;                                                                                              \
+                goto retry;                                                                                            \
+              }                                                                                                        \
+            hm_##KEY##_##VALUE##_table_put (&t, src[s]->entries[i], h);                                                \
+          }                                                                                                            \
+      }                                                                                                                \
+    hm_##KEY##_##VALUE##_table_free (&hm->cur);                                                                        \
+    hm_##KEY##_##VALUE##_table_free (&hm->old);                                                                        \
+    hm->cur         = t;                                                                                               \
+    hm->migrate_pos = 0;                                                                                               \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* Look at up to n slots of old, moving their entries to cur. Erasing at migrate_pos shifts the next entries */      \
+  /* back into it, so the old table stays a valid Robin Hood table that lookups can search. */                         \
+  bool hm_##KEY##_##VALUE##_migrate (hashmap_##KEY##_##VALUE *hm, size_t n)                                            \
+  {                                                                                                                    \
+    hm_##KEY##_##VALUE##_table *old = &hm->old;                                                                        \
+    for (; n > 0 && old->used > 0; n--) /* empty slots count too: a call does O(n) work */                             \
+      {                                                                                                                \
+        size_t i = hm->migrate_pos;                                                                                    \
+        if (!old->ctrl[i])                                                                                             \
+          {                                                                                                            \
+            hm->migrate_pos = (i + 1) & (old->cap - 1);                                                                \
+            continue;                                                                                                  \
+          }                                                                                                            \
+        size_t h = HASH (old->entries[i].key);                                                                         \
+        if (!hm_##KEY##_##VALUE##_table_can_put (&hm->cur, h))                                                         \
+          return hm_##KEY##_##VALUE##_rebuild (hm, 2 * hm->cur.cap);                                                   \
+        hm_##KEY##_##VALUE##_table_put (&hm->cur, old->entries[i], h);                                                 \
+        hm_##KEY##_##VALUE##_table_erase_at (old, i);                                                                  \
+      }                                                                                                                \
+    if (!old->used && old->cap)                                                                                        \
+      {                                                                                                                \
+        hm_##KEY##_##VALUE##_table_free (old);                                                                         \
+        hm->migrate_pos = 0;                                                                                           \
+      }                                                                                                                \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* Make room for one more entry: start migrating into a table twice the size. */                                     \
+  bool hm_##KEY##_##VALUE##_grow (hashmap_##KEY##_##VALUE *hm)                                                         \
+  {                                                                                                                    \
+    if (!hm_##KEY##_##VALUE##_migrate (hm, SIZE_MAX)) /* finish a migration that is still going on */                  \
+      return false;                                                                                                    \
+    if (!hm_too_full (hm->cur.used + 1, hm->cur.cap))                                                                  \
+      return true; /* migrate() had to rebuild into a larger table */                                                  \
+    if (hm->cur.cap > SIZE_MAX / 2)                                                                                    \
+      {                                                                                                                \
+        errno = ENOMEM;                                                                                                \
+        return false;                                                                                                  \
+      }                                                                                                                \
+    hm_##KEY##_##VALUE##_table bigger;                                                                                 \
+    if (!hm_##KEY##_##VALUE##_table_init (&bigger, hm->cur.cap ? 2 * hm->cur.cap : HM_MIN_CAPACITY))                   \
+      return false;                                                                                                    \
+    hm->old         = hm->cur;                                                                                         \
+    hm->cur         = bigger;                                                                                          \
+    hm->migrate_pos = 0;                                                                                               \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  bool hm_##KEY##_##VALUE##_reserve (hashmap_##KEY##_##VALUE *hm, size_t n)                                            \
+  {                                                                                                                    \
+    size_t cap = MAX (hm->cur.cap, HM_MIN_CAPACITY);                                                                   \
+    while (hm_too_full (n, cap))                                                                                       \
+      {                                                                                                                \
+        if (cap > SIZE_MAX / 16)                                                                                       \
+          return false;                                                                                                \
+        cap *= 2;                                                                                                      \
+      }                                                                                                                \
+    if (cap == hm->cur.cap)                                                                                            \
+      return hm_##KEY##_##VALUE##_migrate (hm, SIZE_MAX);                                                              \
+    return hm_##KEY##_##VALUE##_rebuild (hm, cap);                                                                     \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* read-only: lookups never move entries, so they don't take part in the migration */                                \
+  VALUE *hm_##KEY##_##VALUE##_lookup (hashmap_##KEY##_##VALUE *hm, KEY key)                                            \
+  {                                                                                                                    \
+    size_t h = HASH (key);                                                                                             \
+    size_t i = hm_##KEY##_##VALUE##_table_find (&hm->cur, key, h);                                                     \
+    if (i < hm->cur.cap)                                                                                               \
+      return &hm->cur.entries[i].value;                                                                                \
+    i = hm_##KEY##_##VALUE##_table_find (&hm->old, key, h);                                                            \
+    if (i < hm->old.cap)                                                                                               \
+      return &hm->old.entries[i].value;                                                                                \
+    return NULL;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* Inserts or updates. False if there is no memory (errno ENOMEM), or if so many keys hash to the same few slots */  \
+  /* that their distances don't fit into the control bytes even in a much larger table (errno EOVERFLOW: the hash */   \
+  /* is too weak for the keys, see hash_int). The map is unchanged then. */                                            \
+  bool hm_##KEY##_##VALUE##_insert (hashmap_##KEY##_##VALUE *hm, KEY key, VALUE value)                                 \
+  {                                                                                                                    \
+    if (!hm_##KEY##_##VALUE##_migrate (hm, HM_MIGRATE_STEP))                                                           \
+      return false;                                                                                                    \
+    VALUE *v = hm_##KEY##_##VALUE##_lookup (hm, key);                                                                  \
+    if (v)                                                                                                             \
+      {                                                                                                                \
+        *v = value;                                                                                                    \
+        return true;                                                                                                   \
+      }                                                                                                                \
+    if (hm_too_full (hm->cur.used + 1, hm->cur.cap) && !hm_##KEY##_##VALUE##_grow (hm))                                \
+      return false;                                                                                                    \
+    size_t h = HASH (key);                                                                                             \
+    while (!hm_##KEY##_##VALUE##_table_can_put (&hm->cur, h))                                                          \
+      {                                                                                                                \
+        if (hm->cur.cap / 64 > hm_##KEY##_##VALUE##_len (hm))                                                          \
+          {                                                                                                            \
+            errno = EOVERFLOW;                                                                                         \
+            return false;                                                                                              \
+          }                                                                                                            \
+        if (!hm_##KEY##_##VALUE##_rebuild (hm, 2 * hm->cur.cap))                                                       \
+          return false;                                                                                                \
+      }                                                                                                                \
+    hm_##KEY##_##VALUE##_table_put (&hm->cur, (hm_##KEY##_##VALUE##_entry){ .key = key, .value = value }, h);          \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* true if key was in the map */                                                                                     \
+  bool hm_##KEY##_##VALUE##_remove (hashmap_##KEY##_##VALUE *hm, KEY key)                                              \
+  {                                                                                                                    \
+    hm_##KEY##_##VALUE##_migrate (hm, HM_MIGRATE_STEP); /* failing to migrate doesn't stop us from removing */         \
+    size_t h = HASH (key);                                                                                             \
+    size_t i = hm_##KEY##_##VALUE##_table_find (&hm->cur, key, h);                                                     \
+    if (i < hm->cur.cap)                                                                                               \
+      {                                                                                                                \
+        hm_##KEY##_##VALUE##_table_erase_at (&hm->cur, i);                                                             \
+        return true;                                                                                                   \
+      }                                                                                                                \
+    i = hm_##KEY##_##VALUE##_table_find (&hm->old, key, h);                                                            \
+    if (i < hm->old.cap)                                                                                               \
+      {                                                                                                                \
+        hm_##KEY##_##VALUE##_table_erase_at (&hm->old, i);                                                             \
+        return true;                                                                                                   \
+      }                                                                                                                \
+    return false;                                                                                                      \
+  }
+
+#define GEN_HASHMAP(KEY, VALUE, HASH, EQ)                                                                              \
+  GEN_HASHMAP_DECLARATIONS (KEY, VALUE)                                                                                \
+  GEN_HASHMAP_IMPLEMENTATIONS (KEY, VALUE, HASH, EQ)
+
+// -------------------- Macro Calls --------------------------------------------------------------------------------
+
+// The table index is taken from the low bits, so the hash must mix all key bits into them.
+size_t
+hash_int (int key)
+{
+  uint64_t h = (uint32_t)key;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+#define int_eq(a, b) ((a) == (b))
+
+// ---------- int → int ---------------------------------------------------------------------------------------------
+
+GEN_HASHMAP_DECLARATIONS (int, int)                        // goes in .h file
+GEN_HASHMAP_IMPLEMENTATIONS (int, int, hash_int, int_eq)   // goes in .c file
+
+// ---------- int → point -------------------------------------------------------------------------------------------
+
+typedef struct
+{
+  double x, y;
+} point;
+
+GEN_HASHMAP (int, point, hash_int, int_eq)
+
+// -------------------- Search tree from 12_4_iterative.c, for comparison ------------------------------------------
+
+typedef struct node
+{
+  int          value;
+  struct node *left;
+  struct node *right;
+} Node;
+
+typedef Node *stree;
+
+void
+free_nodes (Node *n)
+{
+  Node *curr = n;
+  while (curr)
+    {
+      if (!curr->left)
+        {
+          Node *right = curr->right;
+          free (curr);
+          curr = right;
+        }
+      else
+        {
+          Node *pred = curr->left;
+          while (pred->right)
+            {
+              pred = pred->right;
+            }
+          pred->right = curr;
+          Node *left  = curr->left;
+          curr->left  = NULL;
+          curr        = left;
+        }
+    }
+}
+
+stree *
+find_loc (stree *t, int val)
+{
+  while (*t && val != (*t)->value)
+    {
+      t = (val < (*t)->value) ? &(*t)->left : &(*t)->right;
+    }
+  return t;
+}
+
+bool
+insert (stree *t, int val)
+{
+  stree *loc = find_loc (t, val);
+  if (!*loc)
+    {
+      *loc = malloc (sizeof **loc);
+      if (!*loc)
+        {
+          return false;
+        }
+      **loc = (Node){ .value = val };
+    }
+  return true;
+}
+
+bool
+contains (stree *t, int val)
+{
+  return !!*find_loc (t, val);
+}
+
+// -------------------- Benchmark ----------------------------------------------------------------------------------
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// random keys; some repeat, which both containers treat as updates
+int
+next_key (uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return (int)(*state & INT32_MAX);
+}
+
+void
+benchmark (int n)
+{
+  uint64_t state;
+  long     found;
+
+  printf ("%d random int keys\n", n);
+  printf ("             insert     lookup\n");
+
+  hashmap_int_int hm;
+  hm_int_int_init (&hm);
+  clock_t start = clock ();
+  state         = 42;
+  for (int i = 0; i < n; i++)
+    {
+      if (!hm_int_int_insert (&hm, next_key (&state), i))
+        {
+          abort ();
+        }
+    }
+  double t_insert = seconds_since (start);
+  start           = clock ();
+  state           = 42;
+  found           = 0;
+  for (int i = 0; i < n; i++)
+    {
+      found += !!hm_int_int_lookup (&hm, next_key (&state));
+    }
+  double t_lookup = seconds_since (start);
+  assert (found == n);
+  printf ("hashmap    %7.3fs   %7.3fs\n", t_insert, t_lookup);
+  hm_int_int_dealloc (&hm);
+
+  hm_int_int_init (&hm);
+  start = clock ();
+  state = 42;
+  if (!hm_int_int_reserve (&hm, n))
+    {
+      abort ();
+    }
+  for (int i = 0; i < n; i++)
+    {
+      if (!hm_int_int_insert (&hm, next_key (&state), i))
+        {
+          abort ();
+        }
+    }
+  t_insert = seconds_since (start);
+  printf ("+ reserve  %7.3fs\n", t_insert);
+  hm_int_int_dealloc (&hm);
+
+  stree t = NULL;
+  start   = clock ();
+  state   = 42;
+  for (int i = 0; i < n; i++)
+    {
+      if (!insert (&t, next_key (&state)))
+        {
+          abort ();
+        }
+    }
+  t_insert = seconds_since (start);
+  start    = clock ();
+  state    = 42;
+  found    = 0;
+  for (int i = 0; i < n; i++)
+    {
+      found += contains (&t, next_key (&state));
+    }
+  t_lookup = seconds_since (start);
+  assert (found == n);
+  printf ("stree      %7.3fs   %7.3fs\n", t_insert, t_lookup);
+  free_nodes (t);
+}
+
+// -------------------- Main ---------------------------------------------------------------------------------------
+
+int
+main (int argc, char *argv[])
+{
+  {
+    printf ("-------------- int -> int Hash Map ---------------------------------\n\n");
+
+    hashmap_int_int hm;
+    hm_int_int_init (&hm);
+
+    for (int i = 0; i < 100; i++)
+      {
+        if (!hm_int_int_insert (&hm, i, i * i))
+          {
+            printf ("allocation error\n");
+            hm_int_int_dealloc (&hm);
+            return EXIT_FAILURE;
+          }
+      }
+    printf ("length: %zu, capacity: %zu, still migrating: %zu\n", hm_int_int_len (&hm), hm.cur.cap, hm.old.used);
+
+    for (int i = 0; i < 100; i += 2)
+      {
+        hm_int_int_remove (&hm, i);
+      }
+    printf ("length after removing the even keys: %zu\n", hm_int_int_len (&hm));
+
+    for (int i = 0; i < 10; i++)
+      {
+        int *v = hm_int_int_lookup (&hm, i);
+        if (v)
+          {
+            printf ("%d -> %d\n", i, *v);
+          }
+        else
+          {
+            printf ("%d not found\n", i);
+          }
+      }
+    putchar ('\n');
+    hm_int_int_dealloc (&hm);
+  }
+
+  {
+    printf ("-------------- int -> point Hash Map -------------------------------\n\n");
+
+    hashmap_int_point hm;
+    hm_int_point_init (&hm);
+    if (!hm_int_point_reserve (&hm, 3))
+      {
+        printf ("allocation error\n");
+        return EXIT_FAILURE;
+      }
+
+    hm_int_point_insert (&hm, 7, (point){ .x = 1.0, .y = 2.0 });
+    hm_int_point_insert (&hm, -3, (point){ .x = 3.0, .y = 4.0 });
+    hm_int_point_insert (&hm, 7, (point){ .x = 5.0, .y = 6.0 }); // update
+
+    point *p = hm_int_point_lookup (&hm, 7);
+    printf ("7 -> <%.1f, %.1f>\nlength: %zu\n\n", p->x, p->y, hm_int_point_len (&hm));
+    hm_int_point_dealloc (&hm);
+  }
+
+  printf ("-------------- Benchmark -------------------------------------------\n\n");
+  benchmark (argc > 1 ? atoi (argv[1]) : 10000000);
+}
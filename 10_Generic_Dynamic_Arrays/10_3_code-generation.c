@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/param.h>
 
 #define size_check(n, type)         ((SIZE_MAX / sizeof (type)) >= (n))
@@ -30,7 +31,12 @@
   bool da_##TYPE##_init (dynarray_##TYPE *da, size_t init_size, size_t init_used);                                     \
   void da_##TYPE##_dealloc (dynarray_##TYPE *da);                                                                      \
   bool da_##TYPE##_resize (dynarray_##TYPE *da, size_t new_size);                                                      \
-  bool da_##TYPE##_append (dynarray_##TYPE *da, TYPE val);
+  bool da_##TYPE##_append (dynarray_##TYPE *da, TYPE val);                                                             \
+  bool da_##TYPE##_reserve (dynarray_##TYPE *da, size_t min_size);                                                     \
+  bool da_##TYPE##_append_n (dynarray_##TYPE *da, size_t n, const TYPE *vals);                                         \
+  bool da_##TYPE##_insert_n (dynarray_##TYPE *da, size_t pos, size_t n, const TYPE *vals);                             \
+  void da_##TYPE##_erase_range (dynarray_##TYPE *da, size_t from, size_t to);                                          \
+  bool da_##TYPE##_append_from_fn (dynarray_##TYPE *da, bool (*next) (TYPE *val, void *state), void *state);
 
 #define GEN_DYNARRAY_IMPLEMENTATIONS(TYPE)                                                                             \
   bool da_##TYPE##_init (dynarray_##TYPE *da, size_t init_size, size_t init_used)                                      \
@@ -75,6 +81,74 @@
       }                                                                                                                \
     da->data[da->used++] = val;                                                                                        \
     return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* grow (by doubling) until there is room for min_size elements */                                                   \
+  bool da_##TYPE##_reserve (dynarray_##TYPE *da, size_t min_size)                                                      \
+  {                                                                                                                    \
+    if (min_size <= da->size)                                                                                          \
+      return true;                                                                                                     \
+    size_t new_size = MAX (da->size, MIN_ARRAY_SIZE);                                                                  \
+    while (new_size < min_size)                                                                                        \
+      {                                                                                                                \
+        if (is_at_max_len (new_size, *da->data))                                                                       \
+          return false;                                                                                                \
+        new_size = capped_dbl (new_size, *da->data);                                                                   \
+      }                                                                                                                \
+    return da_##TYPE##_resize (da, new_size);                                                                          \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* one capacity check and one memcpy for n values */                                                                 \
+  bool da_##TYPE##_append_n (dynarray_##TYPE *da, size_t n, const TYPE *vals)                                          \
+  {                                                                                                                    \
+    if (n > max_array_len (*da->data) - da->used)                                                                      \
+      return false;                                                                                                    \
+    if (!da_##TYPE##_reserve (da, da->used + n))                                                                       \
+      return false;                                                                                                    \
+    memcpy (da->data + da->used, vals, n * sizeof *da->data);                                                          \
+    da->used += n;                                                                                                     \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* insert n values before index pos; the tail is moved with a single memmove */                                      \
+  bool da_##TYPE##_insert_n (dynarray_##TYPE *da, size_t pos, size_t n, const TYPE *vals)                              \
+  {                                                                                                                    \
+    assert (pos <= da->used);                                                                                          \
+    if (n > max_array_len (*da->data) - da->used)                                                                      \
+      return false;                                                                                                    \
+    if (!da_##TYPE##_reserve (da, da->used + n))                                                                       \
+      return false;                                                                                                    \
+    memmove (da->data + pos + n, da->data + pos, (da->used - pos) * sizeof *da->data);                                 \
+    memcpy (da->data + pos, vals, n * sizeof *da->data);                                                               \
+    da->used += n;                                                                                                     \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* remove the half-open range [from, to) */                                                                          \
+  void da_##TYPE##_erase_range (dynarray_##TYPE *da, size_t from, size_t to)                                           \
+  {                                                                                                                    \
+    assert (from <= to && to <= da->used);                                                                             \
+    memmove (da->data + from, da->data + to, (da->used - to) * sizeof *da->data);                                      \
+    da->used -= to - from;                                                                                             \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* next() writes directly into the array until it returns false; */                                                  \
+  /* capacity is only checked when the current block is full */                                                        \
+  bool da_##TYPE##_append_from_fn (dynarray_##TYPE *da, bool (*next) (TYPE *val, void *state), void *state)            \
+  {                                                                                                                    \
+    for (;;)                                                                                                           \
+      {                                                                                                                \
+        while (da->used < da->size)                                                                                    \
+          {                                                                                                            \
+            if (!next (&da->data[da->used], state))                                                                    \
+              return true;                                                                                             \
+            da->used++;                                                                                                \
+          }                                                                                                            \
+        if (is_at_max_len (da->size, *da->data))                                                                       \
+          return false;                                                                                                \
+        if (!da_##TYPE##_resize (da, capped_dbl (da->size, *da->data)))                                                \
+          return false;                                                                                                \
+      }                                                                                                                \
   }
 
 // -------------------- Macro Calls --------------------------------------------------------------------------------
@@ -142,6 +216,19 @@ da_point_print (dynarray_point *da)
   printf ("current length: %zu\n\n", da_len (da));
 }
 
+// generator for da_int_append_from_fn(): yields *state - 1, ..., 0
+bool
+count_down (int *val, void *state)
+{
+  int *counter = state;
+  if (*counter == 0)
+    {
+      return false;
+    }
+  *val = --*counter;
+  return true;
+}
+
 // -------------------- Main ---------------------------------------------------------------------------------------
 
 int
@@ -179,6 +266,25 @@ main ()
 
     // print dynarray
     da_int_print (&da);
+
+    // bulk operations
+    int block[] = { -1, -2, -3 };
+    if (!da_int_append_n (&da, 3, block) || !da_int_insert_n (&da, 0, 3, block))
+      {
+        printf ("allocation error");
+      }
+    da_int_print (&da);
+
+    da_int_erase_range (&da, 3, 10); // erase the half-open range [3, 10)
+    da_int_print (&da);
+
+    int counter = 5;
+    if (!da_int_append_from_fn (&da, count_down, &counter))
+      {
+        printf ("allocation error");
+      }
+    da_int_print (&da);
+
     da_int_dealloc (&da); // clean up
   }
 
@@ -0,0 +1,302 @@
+// inlining macros with a small-buffer optimization
+
+// Like 10_4_inline.c, but the struct carries room for N elements.
+// `data` points at the inline buffer until the array outgrows it; only then do we go to the heap.
+// `da_at` and `da_len` only use `data` and `used`, so they are verbatim the same, and `da_init`, `da_append`,
+// `da_dealloc` keep their signatures. The heap-only macros are kept around as `heap_da_*` for the benchmark.
+//
+// Don't copy a small_dynarray by value: the copy's `data` would still point into the original.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <time.h>
+
+#define size_check(n, type)         ((SIZE_MAX / sizeof (type)) >= (n))
+#define checked_malloc(n, type)     (size_check ((n), (type)) ? malloc ((n) * sizeof (type)) : NULL)
+#define checked_realloc(p, n, type) (size_check ((n), (type)) ? realloc ((p), (n) * sizeof (type)) : NULL)
+#define max_array_len(type)         (SIZE_MAX / sizeof (type))
+#define is_at_max_len(n, type)      ((n) == max_array_len (type))
+#define capped_dbl(n, type)         (((n) < max_array_len (type) / 2) ? (2 * (n)) : max_array_len (type))
+#define da_at(da, i)                (da).data[(i)]
+#define da_len(da)                  (da).used
+#define MIN_ARRAY_SIZE              1
+
+// anonymous struct (heap only; as in 10_4_inline.c)
+#define dynarray(TYPE)                                                                                                 \
+  struct                                                                                                               \
+  {                                                                                                                    \
+    size_t size;                                                                                                       \
+    size_t used;                                                                                                       \
+    TYPE  *data;                                                                                                       \
+  }
+
+// anonymous struct with an inline buffer for the first N elements
+#define small_dynarray(TYPE, N)                                                                                        \
+  struct                                                                                                               \
+  {                                                                                                                    \
+    size_t size;                                                                                                       \
+    size_t used;                                                                                                       \
+    TYPE  *data;                                                                                                       \
+    TYPE   small[N];                                                                                                   \
+  }
+
+#define da_is_inline(da) ((da).data == (da).small)
+
+// ---------- dynarray (heap only; the macros from 10_4_inline.c, renamed) -------------------------------------------
+
+#define heap_da_init(da, status, init_size, init_used)                                                                 \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      (da).data = checked_malloc (MAX (init_size, MIN_ARRAY_SIZE), *(da).data);                                        \
+      (da).size = (da).data ? init_size : 0;                                                                           \
+      (da).used = (da).data ? init_used : 0;                                                                           \
+      status    = !!da.data;                                                                                           \
+    }                                                                                                                  \
+  while (0)
+
+#define heap_da_dealloc(da)                                                                                            \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      free ((da).data);                                                                                                \
+      (da).data = 0;                                                                                                   \
+      (da).size = (da).used = 0;                                                                                       \
+    }                                                                                                                  \
+  while (0)
+
+#define heap_da_resize(da, status, new_size)                                                                           \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      size_t alloc_size = MAX (new_size, MIN_ARRAY_SIZE);                                                              \
+      void  *new_data   = checked_realloc ((da).data, alloc_size, *(da).data);                                         \
+      if (!new_data)                                                                                                   \
+        {                                                                                                              \
+          status = false;                                                                                              \
+          break;                                                                                                       \
+        }                                                                                                              \
+      (da).data = new_data;                                                                                            \
+      (da).size = alloc_size;                                                                                          \
+      (da).used = MIN ((da).used, new_size);                                                                           \
+      status    = true;                                                                                                \
+    }                                                                                                                  \
+  while (0)
+
+#define heap_da_append(da, status, ...)                                                                                \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      if ((da).used == (da).size)                                                                                      \
+        {                                                                                                              \
+          if (is_at_max_len ((da).size, *(da).data))                                                                   \
+            {                                                                                                          \
+              status = false;                                                                                          \
+              break;                                                                                                   \
+            }                                                                                                          \
+          size_t new_size = capped_dbl ((da).size, *(da).data);                                                        \
+          heap_da_resize (da, status, new_size);                                                                       \
+          if (!status)                                                                                                 \
+            break;                                                                                                     \
+        }                                                                                                              \
+      (da).data[(da).used++] = __VA_ARGS__;                                                                            \
+      status                 = true;                                                                                   \
+    }                                                                                                                  \
+  while (0)
+
+// ---------- small_dynarray -----------------------------------------------------------------------------------------
+
+// Small initial sizes don't allocate; status is only false if a larger init_size cannot be malloc'ed.
+#define da_init(da, status, init_size, init_used)                                                                      \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      size_t n_small = sizeof (da).small / sizeof *(da).small;                                                         \
+      size_t n_init  = (init_size);                                                                                    \
+      (da).data      = n_init <= n_small ? (da).small : checked_malloc (n_init, *(da).data);                           \
+      (da).size      = (da).data ? MAX (n_init, n_small) : 0;                                                          \
+      (da).used      = (da).data ? (init_used) : 0;                                                                    \
+      status         = !!(da).data;                                                                                    \
+    }                                                                                                                  \
+  while (0)
+
+#define da_dealloc(da)                                                                                                 \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      if (!da_is_inline (da))                                                                                          \
+        free ((da).data);                                                                                              \
+      (da).data = (da).small;                                                                                          \
+      (da).size = sizeof (da).small / sizeof *(da).small;                                                              \
+      (da).used = 0;                                                                                                   \
+    }                                                                                                                  \
+  while (0)
+
+// The first time we spill we cannot realloc() the inline buffer, so we malloc() and copy. A size that still fits
+// into `small` keeps the inline buffer.
+#define da_resize(da, status, new_size)                                                                                \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      size_t n_small = sizeof (da).small / sizeof *(da).small;                                                         \
+      if (da_is_inline (da) && (new_size) <= n_small) /* still fits, nothing to allocate */                            \
+        {                                                                                                              \
+          (da).used = MIN ((da).used, (size_t)(new_size));                                                             \
+          status    = true;                                                                                            \
+          break;                                                                                                       \
+        }                                                                                                              \
+      size_t alloc_size = MAX (new_size, MIN_ARRAY_SIZE);                                                              \
+      void  *new_data   = da_is_inline (da) ? checked_malloc (alloc_size, *(da).data)                                  \
+                                            : checked_realloc ((da).data, alloc_size, *(da).data);                     \
+      if (!new_data)                                                                                                   \
+        {                                                                                                              \
+          status = false;                                                                                              \
+          break;                                                                                                       \
+        }                                                                                                              \
+      if (da_is_inline (da))                                                                                           \
+        memcpy (new_data, (da).small, MIN ((da).used, alloc_size) * sizeof *(da).data);                                \
+      (da).data = new_data;                                                                                            \
+      (da).size = alloc_size;                                                                                          \
+      (da).used = MIN ((da).used, new_size);                                                                           \
+      status    = true;                                                                                                \
+    }                                                                                                                  \
+  while (0)
+
+#define da_append(da, status, ...)                                                                                     \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      if ((da).used == (da).size)                                                                                      \
+        {                                                                                                              \
+          if (is_at_max_len ((da).size, *(da).data))                                                                   \
+            {                                                                                                          \
+              status = false;                                                                                          \
+              break;                                                                                                   \
+            }                                                                                                          \
+          size_t new_size = capped_dbl ((da).size, *(da).data);                                                        \
+          da_resize (da, status, new_size);                                                                            \
+          if (!status)                                                                                                 \
+            break;                                                                                                     \
+        }                                                                                                              \
+      (da).data[(da).used++] = __VA_ARGS__;                                                                            \
+      status                 = true;                                                                                   \
+    }                                                                                                                  \
+  while (0)
+
+// ---------- Custom Data Type ---------------------------------------------------------------------------------------
+
+typedef struct
+{
+  double x, y;
+} point;
+
+// ---------- Benchmark ----------------------------------------------------------------------------------------------
+
+// Many short-lived arrays with `len` elements each; the sum keeps the compiler from dropping the work.
+
+long
+bench_dynarray (int n_arrays, int len)
+{
+  long sum = 0;
+  for (int k = 0; k < n_arrays; k++)
+    {
+      bool success;
+      dynarray (int) da;
+      heap_da_init (da, success, 0, 0);
+      for (int i = 0; success && i < len; i++)
+        {
+          heap_da_append (da, success, k + i);
+        }
+      if (!success)
+        {
+          abort ();
+        }
+      for (size_t i = 0; i < da_len (da); i++)
+        {
+          sum += da_at (da, i);
+        }
+      heap_da_dealloc (da);
+    }
+  return sum;
+}
+
+long
+bench_small_dynarray (int n_arrays, int len)
+{
+  long sum = 0;
+  for (int k = 0; k < n_arrays; k++)
+    {
+      bool success;
+      small_dynarray (int, 8) da;
+      da_init (da, success, 0, 0);
+      for (int i = 0; success && i < len; i++)
+        {
+          da_append (da, success, k + i);
+        }
+      if (!success)
+        {
+          abort ();
+        }
+      for (size_t i = 0; i < da_len (da); i++)
+        {
+          sum += da_at (da, i);
+        }
+      da_dealloc (da);
+    }
+  return sum;
+}
+
+void
+benchmark (int n_arrays)
+{
+  int lens[] = { 1, 4, 8, 16 };
+
+  printf ("%d arrays per run, inline capacity 8\n", n_arrays);
+  printf ("len   dynarray   small_dynarray\n");
+  for (size_t i = 0; i < sizeof lens / sizeof *lens; i++)
+    {
+      clock_t start   = clock ();
+      long    sum1    = bench_dynarray (n_arrays, lens[i]);
+      double  t_heap  = (double)(clock () - start) / CLOCKS_PER_SEC;
+      start           = clock ();
+      long    sum2    = bench_small_dynarray (n_arrays, lens[i]);
+      double  t_small = (double)(clock () - start) / CLOCKS_PER_SEC;
+      if (sum1 != sum2)
+        {
+          abort ();
+        }
+      printf ("%3d   %7.3fs   %7.3fs\n", lens[i], t_heap, t_small);
+    }
+}
+
+// ---------- main ---------------------------------------------------------------------------------------------------
+
+int
+main (int argc, char *argv[])
+{
+  bool success;
+  small_dynarray (point, 4) da;
+
+  da_init (da, success, 0, 0);
+
+  // the first four points live inside `da`, the rest spills to the heap
+  for (int i = 0; i < 6; i++)
+    {
+      da_append (da, success,
+                 (point){
+                     .x = i + 1,
+                     .y = -i - 1,
+                 });
+
+      if (!success)
+        {
+          goto error;
+        }
+      printf ("<%.2f, %.2f> %s\n", da_at (da, i).x, da_at (da, i).y, da_is_inline (da) ? "inline" : "heap");
+    }
+
+  da_dealloc (da);
+
+  benchmark (argc > 1 ? atoi (argv[1]) : 10000000);
+  return EXIT_SUCCESS;
+
+error:
+  da_dealloc (da);
+  return EXIT_FAILURE;
+}
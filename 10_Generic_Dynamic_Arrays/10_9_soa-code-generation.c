@@ -0,0 +1,405 @@
+// Generate struct-of-arrays (SoA) code using macros.
+
+// 10_3_code-generation.c stores records as an array of structs (AoS): x0 y0 x1 y1 x2 y2 ...
+// Here every field gets its own column:                                x0 x1 x2 ... y0 y1 y2 ...
+// A scan over one field then touches only that column, and the loop over it can be vectorized.
+//
+// Fields are given as (TYPE, NAME) pairs:
+//   GEN_SOA_DYNARRAY (point, (double, x), (double, y))
+// generates the record type `point`, the column container `soa_point` and its functions.
+//
+// Build with optimizations to see the difference: make CFLAGS=-O3 10_9_soa-code-generation
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/param.h>
+#include <time.h>
+
+#define size_check(n, type)         ((SIZE_MAX / sizeof (type)) >= (n))
+#define checked_malloc(n, type)     (size_check ((n), (type)) ? malloc ((n) * sizeof (type)) : NULL)
+#define checked_realloc(p, n, type) (size_check ((n), (type)) ? realloc ((p), (n) * sizeof (type)) : NULL)
+#define max_array_len(type)         (SIZE_MAX / sizeof (type))
+#define is_at_max_len(n, type)      ((n) == max_array_len (type))
+#define capped_dbl(n, type)         (((n) < max_array_len (type) / 2) ? (2 * (n)) : max_array_len (type))
+#define MIN_ARRAY_SIZE              1
+#define da_at(da, i)                (da)->data[(i)]
+#define da_len(da)                  (da)->used
+
+// -------------------- Field List Iteration ------------------------------------------------------------------------
+
+// SOA_MAP (M, NAME, (T1, F1), (T2, F2), ...) expands to M (NAME, T1, F1) M (NAME, T2, F2) ... (up to 8 fields).
+// SOA_APPLY is an extra level of expansion so the (TYPE, FIELD) pair is split before M pastes tokens with ##.
+
+#define SOA_TYPE(T, F)                                     T
+#define SOA_FIELD(T, F)                                    F
+#define SOA_CAT_(a, b)                                     a##b
+#define SOA_CAT(a, b)                                      SOA_CAT_ (a, b)
+#define SOA_APPLY(M, NAME, T, F)                           M (NAME, T, F)
+#define SOA_EACH(M, NAME, PAIR)                            SOA_APPLY (M, NAME, SOA_TYPE PAIR, SOA_FIELD PAIR)
+#define SOA_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define SOA_NARGS(...)                                     SOA_NARGS_ (__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1)
+
+#define SOA_MAP_1(M, NAME, P)      SOA_EACH (M, NAME, P)
+#define SOA_MAP_2(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_1 (M, NAME, __VA_ARGS__)
+#define SOA_MAP_3(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_2 (M, NAME, __VA_ARGS__)
+#define SOA_MAP_4(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_3 (M, NAME, __VA_ARGS__)
+#define SOA_MAP_5(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_4 (M, NAME, __VA_ARGS__)
+#define SOA_MAP_6(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_5 (M, NAME, __VA_ARGS__)
+#define SOA_MAP_7(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_6 (M, NAME, __VA_ARGS__)
+#define SOA_MAP_8(M, NAME, P, ...) SOA_EACH (M, NAME, P) SOA_MAP_7 (M, NAME, __VA_ARGS__)
+#define SOA_MAP(M, NAME, ...)      SOA_CAT (SOA_MAP_, SOA_NARGS (__VA_ARGS__)) (M, NAME, __VA_ARGS__)
+
+// -------------------- Per-Field Snippets --------------------------------------------------------------------------
+
+#define SOA_RECORD_MEMBER(NAME, T, F) T F;
+#define SOA_COLUMN_MEMBER(NAME, T, F) T *F;
+#define SOA_COLUMN_NULL(NAME, T, F)   da->F = NULL;
+#define SOA_COLUMN_FREE(NAME, T, F)   free (da->F);
+#define SOA_COLUMN_STORE(NAME, T, F)  da->F[i] = val.F;
+#define SOA_COLUMN_LOAD(NAME, T, F)   val.F = da->F[i];
+
+// realloc() keeps the old block on failure, so a partial resize leaves every column at least da->size long
+#define SOA_COLUMN_REALLOC(NAME, T, F)                                                                                 \
+  {                                                                                                                    \
+    T *new_column = checked_realloc (da->F, alloc_size, *da->F);                                                       \
+    if (!new_column)                                                                                                   \
+      return false;                                                                                                    \
+    da->F = new_column;                                                                                                \
+  }
+
+#define SOA_COLUMN_DECLARATION(NAME, T, F) T *soa_##NAME##_##F (soa_##NAME *da);
+
+#define SOA_COLUMN_IMPLEMENTATION(NAME, T, F)                                                                          \
+  T *soa_##NAME##_##F (soa_##NAME *da)                                                                                 \
+  {                                                                                                                    \
+    return da->F;                                                                                                      \
+  }
+
+// -------------------- Macro Definitions ---------------------------------------------------------------------------
+
+#define soa_at(da, field, i) (da)->field[(i)]
+#define soa_len(da)          (da)->used
+
+// bulk iteration over one column; p points at each element of the column in turn
+#define soa_for_each(da, field, p) for (__typeof__ ((da)->field) p = (da)->field; p < (da)->field + (da)->used; p++)
+
+#define GEN_SOA_DYNARRAY_DECLARATIONS(NAME, ...)                                                                       \
+  typedef struct                                                                                                       \
+  {                                                                                                                    \
+    SOA_MAP (SOA_RECORD_MEMBER, NAME, __VA_ARGS__)                                                                     \
+  } NAME;                                                                                                              \
+                                                                                                                       \
+  typedef struct soa_##NAME                                                                                            \
+  {                                                                                                                    \
+    size_t size;                                                                                                       \
+    size_t used;                                                                                                       \
+    SOA_MAP (SOA_COLUMN_MEMBER, NAME, __VA_ARGS__)                                                                     \
+  } soa_##NAME;                                                                                                        \
+                                                                                                                       \
+  bool soa_##NAME##_init (soa_##NAME *da, size_t init_size, size_t init_used);                                         \
+  void soa_##NAME##_dealloc (soa_##NAME *da);                                                                          \
+  bool soa_##NAME##_resize (soa_##NAME *da, size_t new_size);                                                          \
+  bool soa_##NAME##_append (soa_##NAME *da, NAME val);                                                                 \
+  NAME soa_##NAME##_get (soa_##NAME *da, size_t i);                                                                    \
+  void soa_##NAME##_set (soa_##NAME *da, size_t i, NAME val);                                                          \
+  SOA_MAP (SOA_COLUMN_DECLARATION, NAME, __VA_ARGS__)
+
+#define GEN_SOA_DYNARRAY_IMPLEMENTATIONS(NAME, ...)                                                                    \
+  void soa_##NAME##_dealloc (soa_##NAME *da)                                                                           \
+  {                                                                                                                    \
+    SOA_MAP (SOA_COLUMN_FREE, NAME, __VA_ARGS__)                                                                       \
+    SOA_MAP (SOA_COLUMN_NULL, NAME, __VA_ARGS__)                                                                       \
+    da->size = da->used = 0;                                                                                           \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* when shrinking, size is updated first; a failed realloc() then just leaves a column larger than needed */         \
+  bool soa_##NAME##_resize (soa_##NAME *da, size_t new_size)                                                           \
+  {                                                                                                                    \
+    size_t alloc_size = MAX (new_size, MIN_ARRAY_SIZE);                                                                \
+    if (alloc_size < da->size)                                                                                         \
+      {                                                                                                                \
+        da->size = alloc_size;                                                                                         \
+        da->used = MIN (da->used, new_size);                                                                           \
+      }                                                                                                                \
+    SOA_MAP (SOA_COLUMN_REALLOC, NAME, __VA_ARGS__)                                                                    \
+    da->size = alloc_size;                                                                                             \
+    da->used = MIN (da->used, new_size);                                                                               \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  bool soa_##NAME##_init (soa_##NAME *da, size_t init_size, size_t init_used)                                          \
+  {                                                                                                                    \
+    assert (init_size >= init_used);                                                                                   \
+    SOA_MAP (SOA_COLUMN_NULL, NAME, __VA_ARGS__)                                                                       \
+    da->size = da->used = 0;                                                                                           \
+    if (!soa_##NAME##_resize (da, init_size))                                                                          \
+      {                                                                                                                \
+        soa_##NAME##_dealloc (da);                                                                                     \
+        return false;                                                                                                  \
+      }                                                                                                                \
+    da->used = init_used;                                                                                              \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  bool soa_##NAME##_append (soa_##NAME *da, NAME val)                                                                  \
+  {                                                                                                                    \
+    if (da->used == da->size)                                                                                          \
+      {                                                                                                                \
+        if (is_at_max_len (da->size, NAME))                                                                            \
+          return false;                                                                                                \
+        size_t new_size       = capped_dbl (da->size, NAME);                                                           \
+        int    resize_success = soa_##NAME##_resize (da, new_size);                                                    \
+        if (!resize_success)                                                                                           \
+          return false;                                                                                                \
+      }                                                                                                                \
+    size_t i = da->used++;                                                                                             \
+    SOA_MAP (SOA_COLUMN_STORE, NAME, __VA_ARGS__)                                                                      \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  NAME soa_##NAME##_get (soa_##NAME *da, size_t i)                                                                     \
+  {                                                                                                                    \
+    NAME val;                                                                                                          \
+    SOA_MAP (SOA_COLUMN_LOAD, NAME, __VA_ARGS__)                                                                       \
+    return val;                                                                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  void soa_##NAME##_set (soa_##NAME *da, size_t i, NAME val)                                                           \
+  {                                                                                                                    \
+    SOA_MAP (SOA_COLUMN_STORE, NAME, __VA_ARGS__)                                                                      \
+  }                                                                                                                    \
+                                                                                                                       \
+  SOA_MAP (SOA_COLUMN_IMPLEMENTATION, NAME, __VA_ARGS__)
+
+#define GEN_SOA_DYNARRAY(NAME, ...)                                                                                    \
+  GEN_SOA_DYNARRAY_DECLARATIONS (NAME, __VA_ARGS__)                                                                    \
+  GEN_SOA_DYNARRAY_IMPLEMENTATIONS (NAME, __VA_ARGS__)
+
+// AoS generator from 10_3_code-generation.c, used for comparison
+#define GEN_DYNARRAY_DECLARATIONS(TYPE)                                                                                \
+  typedef struct dynarray_##TYPE                                                                                       \
+  {                                                                                                                    \
+    size_t size;                                                                                                       \
+    size_t used;                                                                                                       \
+    TYPE  *data;                                                                                                       \
+  } dynarray_##TYPE;                                                                                                   \
+                                                                                                                       \
+  bool da_##TYPE##_init (dynarray_##TYPE *da, size_t init_size, size_t init_used);                                     \
+  void da_##TYPE##_dealloc (dynarray_##TYPE *da);                                                                      \
+  bool da_##TYPE##_resize (dynarray_##TYPE *da, size_t new_size);                                                      \
+  bool da_##TYPE##_append (dynarray_##TYPE *da, TYPE val);
+
+#define GEN_DYNARRAY_IMPLEMENTATIONS(TYPE)                                                                             \
+  bool da_##TYPE##_init (dynarray_##TYPE *da, size_t init_size, size_t init_used)                                      \
+  {                                                                                                                    \
+    assert (init_size >= init_used);                                                                                   \
+    init_size = MAX (init_size, MIN_ARRAY_SIZE);                                                                       \
+    da->data  = checked_malloc (init_size, *da->data);                                                                 \
+    da->size  = (da->data) ? init_size : 0;                                                                            \
+    da->used  = (da->data) ? init_used : 0;                                                                            \
+    return !!da->data;                                                                                                 \
+  }                                                                                                                    \
+                                                                                                                       \
+  void da_##TYPE##_dealloc (dynarray_##TYPE *da)                                                                       \
+  {                                                                                                                    \
+    free (da->data);                                                                                                   \
+    da->data = 0;                                                                                                      \
+    da->size = da->used = 0;                                                                                           \
+  }                                                                                                                    \
+                                                                                                                       \
+  bool da_##TYPE##_resize (dynarray_##TYPE *da, size_t new_size)                                                       \
+  {                                                                                                                    \
+    size_t alloc_size = MAX (new_size, MIN_ARRAY_SIZE);                                                                \
+    TYPE  *new_data   = checked_realloc (da->data, alloc_size, *da->data);                                             \
+    if (!new_data)                                                                                                     \
+      return false;                                                                                                    \
+    da->data = new_data;                                                                                               \
+    da->size = alloc_size;                                                                                             \
+    da->used = MIN (da->used, new_size);                                                                               \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  bool da_##TYPE##_append (dynarray_##TYPE *da, TYPE val)                                                              \
+  {                                                                                                                    \
+    if (da->used == da->size)                                                                                          \
+      {                                                                                                                \
+        if (is_at_max_len (da->size, *da->data))                                                                       \
+          return false;                                                                                                \
+        size_t new_size       = capped_dbl (da->size, *da->data);                                                      \
+        int    resize_success = da_##TYPE##_resize (da, new_size);                                                     \
+        if (!resize_success)                                                                                           \
+          return false;                                                                                                \
+      }                                                                                                                \
+    da->data[da->used++] = val;                                                                                        \
+    return true;                                                                                                       \
+  }
+
+// -------------------- Macro Calls --------------------------------------------------------------------------------
+
+// ---------- Point: SoA -------------------------------------------------------------------------------------------
+
+GEN_SOA_DYNARRAY_DECLARATIONS (point, (double, x), (double, y))    // goes in .h file
+GEN_SOA_DYNARRAY_IMPLEMENTATIONS (point, (double, x), (double, y)) // goes in .c file
+
+// ---------- Point: AoS -------------------------------------------------------------------------------------------
+
+GEN_DYNARRAY_DECLARATIONS (point)
+GEN_DYNARRAY_IMPLEMENTATIONS (point)
+
+// ---------- Particle: SoA with mixed field types -----------------------------------------------------------------
+
+GEN_SOA_DYNARRAY (particle, (float, mass), (double, pos), (int, id))
+
+// -------------------- Benchmark ----------------------------------------------------------------------------------
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+void
+benchmark (size_t n, int n_scans)
+{
+  dynarray_point aos;
+  soa_point      soa;
+
+  if (!da_point_init (&aos, 0, 0) || !soa_point_init (&soa, 0, 0))
+    {
+      abort ();
+    }
+
+  clock_t start = clock ();
+  for (size_t i = 0; i < n; i++)
+    {
+      if (!da_point_append (&aos, (point){ .x = i, .y = -(double)i }))
+        {
+          abort ();
+        }
+    }
+  double t_aos_append = seconds_since (start);
+
+  start = clock ();
+  for (size_t i = 0; i < n; i++)
+    {
+      if (!soa_point_append (&soa, (point){ .x = i, .y = -(double)i }))
+        {
+          abort ();
+        }
+    }
+  double t_soa_append = seconds_since (start);
+
+  // sum of all x; AoS strides over the y values as well
+  double sum_aos = 0.0;
+  start          = clock ();
+  for (int k = 0; k < n_scans; k++)
+    {
+      for (size_t i = 0; i < da_len (&aos); i++)
+        {
+          sum_aos += da_at (&aos, i).x;
+        }
+    }
+  double t_aos_scan = seconds_since (start);
+
+  double sum_soa = 0.0;
+  start          = clock ();
+  for (int k = 0; k < n_scans; k++)
+    {
+      double *xs = soa_point_x (&soa);
+      for (size_t i = 0; i < soa_len (&soa); i++)
+        {
+          sum_soa += xs[i];
+        }
+    }
+  double t_soa_scan = seconds_since (start);
+
+  if (sum_aos != sum_soa)
+    {
+      abort ();
+    }
+
+  printf ("%zu points, %d scans of x\n", n, n_scans);
+  printf ("         append     scan\n");
+  printf ("AoS    %7.3fs  %7.3fs\n", t_aos_append, t_aos_scan);
+  printf ("SoA    %7.3fs  %7.3fs\n", t_soa_append, t_soa_scan);
+
+  da_point_dealloc (&aos);
+  soa_point_dealloc (&soa);
+}
+
+// -------------------- Main ---------------------------------------------------------------------------------------
+
+int
+main (int argc, char *argv[])
+{
+  {
+    printf ("-------------- Point SoA Dynamic Array -----------------------------\n\n");
+
+    soa_point da;
+    if (!soa_point_init (&da, 0, 0))
+      {
+        printf ("allocation error\n");
+        return EXIT_FAILURE;
+      }
+
+    for (int i = 0; i < 5; i++)
+      {
+        if (!soa_point_append (&da, (point){ .x = i, .y = 10.0 * i }))
+          {
+            printf ("allocation error\n");
+            break;
+          }
+      }
+
+    soa_at (&da, y, 0) = -1.0; // field accessor
+
+    for (size_t i = 0; i < soa_len (&da); i++)
+      {
+        point p = soa_point_get (&da, i);
+        printf ("<%.1f, %.1f>\n", p.x, p.y);
+      }
+
+    double sum = 0.0;
+    soa_for_each (&da, x, p) // bulk column iteration
+    {
+      sum += *p;
+    }
+    printf ("sum of x: %.1f\ncurrent length: %zu\n\n", sum, soa_len (&da));
+
+    soa_point_dealloc (&da);
+  }
+
+  {
+    printf ("-------------- Particle SoA Dynamic Array --------------------------\n\n");
+
+    soa_particle da;
+    if (!soa_particle_init (&da, 4, 0))
+      {
+        printf ("allocation error\n");
+        return EXIT_FAILURE;
+      }
+
+    for (int i = 0; i < 3; i++)
+      {
+        if (!soa_particle_append (&da, (particle){ .mass = 1.5f * i, .pos = -i, .id = 100 + i }))
+          {
+            printf ("allocation error\n");
+            break;
+          }
+      }
+
+    for (size_t i = 0; i < soa_len (&da); i++)
+      {
+        printf ("id %d: mass %.1f at %.1f\n", soa_at (&da, id, i), soa_at (&da, mass, i), soa_at (&da, pos, i));
+      }
+    printf ("current length: %zu\n\n", soa_len (&da));
+
+    soa_particle_dealloc (&da);
+  }
+
+  printf ("-------------- Benchmark -------------------------------------------\n\n");
+  benchmark (argc > 1 ? strtoul (argv[1], NULL, 10) : 10000000, 10);
+}
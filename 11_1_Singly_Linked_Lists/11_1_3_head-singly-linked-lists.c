@@ -1,28 +1,13 @@
 // Adding a dummy element.
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
-// fake malloc
-void *(*ml) (size_t) = malloc;
-
-void *
-fake_malloc (size_t size)
-{
-  if (rand () % 100 == 0)
-    {
-      return NULL;
-    }
-  else
-    {
-      return ml (size);
-    }
-}
-
-// comment out next line to use standard malloc()
-// #define malloc fake_malloc
+// To let malloc() fail now and then, run with the allocation shim from 09_Dynamic_Memory_Management, e.g.:
+// ALLOCSHIM_FAIL_RATE=1 LD_PRELOAD=../09_Dynamic_Memory_Management/liballocshim.so ./11_1_3_head-singly-linked-lists
 
 typedef struct link
 {
@@ -130,6 +115,84 @@ contains (List x, int val)
   return false;
 }
 
+int
+cmp_ints (const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// Index of `val` in sorted `vals` or -1.
+long
+bsearch_index (int val, const int *vals, size_t k)
+{
+  size_t lo = 0;
+  size_t hi = k;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (vals[mid] < val)
+        {
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+  return (lo < k && vals[lo] == val) ? (long)lo : -1;
+}
+
+// Answers k membership queries with one pass over the list instead of k passes: out[i] is set to contains (x, vals[i]).
+// A singly linked list is a single chain of dependent loads, so batching the queries is the way to save walks.
+// Returns false if there is no memory for the sorted copy of the queries (or k is too large for one).
+bool
+contains_many (List x, int *vals, size_t k, bool *out)
+{
+  if (k > (SIZE_MAX - 1) / (sizeof (int) + sizeof (bool)))
+    {
+      return false;
+    }
+  int *sorted = malloc (k * (sizeof *sorted + sizeof (bool)) + 1);
+  if (!sorted)
+    {
+      return false;
+    }
+  bool *found = (bool *)(sorted + k);
+  memcpy (sorted, vals, k * sizeof *vals);
+  qsort (sorted, k, sizeof *sorted, cmp_ints);
+
+  // remove duplicates
+  size_t distinct = 0;
+  for (size_t i = 0; i < k; i++)
+    {
+      if (distinct == 0 || sorted[i] != sorted[distinct - 1])
+        {
+          sorted[distinct++] = sorted[i];
+        }
+    }
+  memset (found, false, distinct);
+
+  size_t n_found = 0;
+  for (Link *link = x->next; link && n_found < distinct; link = link->next) // skip dummy link
+    {
+      long i = bsearch_index (link->value, sorted, distinct);
+      if (i >= 0 && !found[i])
+        {
+          found[i] = true;
+          n_found++;
+        }
+    }
+
+  for (size_t i = 0; i < k; i++)
+    {
+      out[i] = found[bsearch_index (vals[i], sorted, distinct)];
+    }
+  free (sorted);
+  return true;
+}
+
 bool
 prepend (List x, int val)
 {
@@ -219,7 +282,6 @@ int
 main ()
 {
   bool success;
-  srand (time (0));
   int array[] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5 };
   int n       = ARRAY_SIZE (array);
 
@@ -234,6 +296,23 @@ main ()
     free_list (x);
   }
 
+  {
+    // -------------------- Contains Many ---------------------------------------------
+
+    List x = make_list_from_array (n, array);
+    EH (x, "make list error");
+    int  queries[] = { 0, 3, 6, 3 };
+    bool out[ARRAY_SIZE (queries)];
+    EH (contains_many (x, queries, ARRAY_SIZE (queries), out), "allocation error");
+    printf ("\ncontains_many:\n0 3 6 3:\n");
+    for (size_t i = 0; i < ARRAY_SIZE (queries); i++)
+      {
+        printf ("%s ", out[i] ? "✓" : "✗");
+      }
+    printf ("\n");
+    free_list (x);
+  }
+
   {
     // -------------------- Prepend/Append --------------------------------------------
 
@@ -0,0 +1,468 @@
+// Taking links from a pool instead of malloc().
+// The list code is 11_1_3 (with dummy link); the pool is the free-list subpool from
+// 16_Allocation_Pools/16_3_node_pool-free.c with `Link` in place of the tree `node`.
+// Every function that allocates or frees links takes a pool; NULL means malloc()/free().
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct link
+{
+  int          value;
+  struct link *next;
+} Link;
+
+// A list is a pointer to the first link in the list, the so-called dummy link.
+// The dummy link is always present.
+// Link → Dummy Link → Link → ... → Link → NULL
+typedef Link *List;
+
+// -------------------- Link Pool ---------------------------------------------------
+
+// basically a link; but if a link is not used, will contain a pointer to the next free link
+typedef union link_free_list
+{
+  union link_free_list *next_free_link;
+  Link                  link;
+} LinkFreeList;
+
+// linked list of subpools; each subpool contains an array of links
+typedef struct link_subpool
+{
+  struct link_subpool *next_subpool; // linked list of subpools
+  LinkFreeList         links[];      // flexible array member must be at end of struct
+} LinkSubpool;
+
+// A list of subpools and free links. Links of a new subpool are handed out in order (`next_unused` up to
+// `end_unused`); links given back are kept on the free list and reused first.
+typedef struct link_pool
+{
+  size_t        capacity;       // capacity of the newest subpool
+  LinkFreeList *next_free_link; // points to first link given back with link_free()
+  LinkFreeList *next_unused;    // next never used link in the newest subpool …
+  LinkFreeList *end_unused;     // … up to here
+  LinkSubpool  *subpool;        // points to begin of subpool linked list
+} LinkPool;
+
+// `next_subpool` is an existing subpool or NULL.
+LinkSubpool *
+new_subpool (size_t capacity, LinkSubpool *next_subpool)
+{
+  LinkSubpool *sp = malloc (offsetof (LinkSubpool, links) + (sizeof *sp->links) * capacity);
+  if (!sp)
+    {
+      return NULL;
+    }
+  sp->next_subpool = next_subpool;
+  return sp;
+}
+
+// Creates new `LinkPool` with initial `capacity` (at least 1).
+LinkPool *
+new_link_pool (size_t capacity)
+{
+  LinkPool *pool = malloc (sizeof *pool);
+  if (!pool)
+    {
+      return NULL;
+    }
+  capacity        = capacity ? capacity : 1;
+  LinkSubpool *sp = new_subpool (capacity, NULL);
+  if (!sp)
+    {
+      free (pool);
+      return NULL;
+    }
+
+  pool->capacity       = capacity;
+  pool->next_free_link = NULL;
+  pool->next_unused    = sp->links;
+  pool->end_unused     = sp->links + capacity;
+  pool->subpool        = sp;
+
+  return pool;
+}
+
+// Frees all links that came from `pool`, in O(number of subpools).
+void
+free_link_pool (LinkPool *pool)
+{
+  LinkSubpool *sp = pool->subpool;
+  while (sp)
+    {
+      LinkSubpool *next = sp->next_subpool;
+      free (sp);
+      sp = next;
+    }
+  free (pool);
+}
+
+// Get link from pool (or from malloc() if there is no pool).
+Link *
+link_alloc (LinkPool *pool)
+{
+  if (!pool)
+    {
+      return malloc (sizeof (Link));
+    }
+
+  if (pool->next_free_link)
+    {
+      Link *link           = &pool->next_free_link->link;
+      pool->next_free_link = pool->next_free_link->next_free_link;
+      return link;
+    }
+
+  if (pool->next_unused == pool->end_unused)
+    {
+      // add a pool twice as large as the current largest pool - if we can.
+      if (SIZE_MAX / 2 / sizeof (LinkFreeList) < pool->capacity)
+        {
+          return NULL;
+        }
+      size_t       new_size = 2 * pool->capacity;
+      LinkSubpool *sp       = new_subpool (new_size, pool->subpool);
+      if (!sp)
+        {
+          return NULL;
+        }
+      // add new sub pool to pool
+      pool->capacity    = new_size;
+      pool->next_unused = sp->links;
+      pool->end_unused  = sp->links + new_size;
+      pool->subpool     = sp;
+    }
+  return &pool->next_unused++->link;
+}
+
+// Give link back to pool (or to free() if there is no pool).
+void
+link_free (LinkPool *pool, Link *link)
+{
+  if (!pool)
+    {
+      free (link);
+      return;
+    }
+  LinkFreeList *free_list    = (LinkFreeList *)link;
+  free_list->next_free_link = pool->next_free_link;
+  pool->next_free_link      = free_list;
+}
+
+// -------------------- List --------------------------------------------------------
+
+Link *
+new_link (LinkPool *pool, int val, Link *next)
+{
+  Link *link = link_alloc (pool);
+  if (!link)
+    {
+      return NULL;
+    }
+  link->value = val;
+  link->next  = next;
+  return link;
+}
+
+// Free all links in a list including the dummy link.
+// With a pool there is no need to call this if the whole pool goes away; free_link_pool() frees all its lists.
+void
+free_links (LinkPool *pool, List x)
+{
+  while (x)
+    {
+      Link *next = x->next;
+      link_free (pool, x);
+      x = next;
+    }
+}
+
+// New list is an empty list with a single dummy link; value could be anything.
+#define new_empty_list(pool) new_link (pool, 314159, NULL)
+#define free_list(pool, x)   free_links (pool, x)
+
+List
+make_list_from_array (LinkPool *pool, int n, int array[n])
+{
+  List x = new_empty_list (pool); // create dummy link
+  if (!x)
+    {
+      return NULL;
+    }
+
+  for (int i = n - 1; i >= 0; i--)
+    {
+      Link *newLink = new_link (pool, array[i], x->next);
+      if (!newLink)
+        {
+          free_list (pool, x);
+          return NULL;
+        }
+      x->next = newLink; // connect dummy link to new link
+    }
+
+  return x;
+}
+
+void
+print_list (List x)
+{
+  printf ("[ ");
+  Link *link = x->next; // skip dummy link and get first real link
+  while (link)
+    {
+      printf ("%d ", link->value);
+      link = link->next;
+    }
+  printf ("]\n");
+}
+
+bool
+prepend (LinkPool *pool, List x, int val)
+{
+  Link *link = new_link (pool, val, x->next);
+  if (!link)
+    {
+      return false;
+    }
+  x->next = link; // connect dummy link to new link
+  return true;
+}
+
+void
+delete_value (LinkPool *pool, List x, int val)
+{
+  Link *front = x; // pointer to dummy link
+  Link *next;      // front and next are neighbors - front comes before next
+
+  while (front)
+    {
+      while ((next = front->next) && next->value == val)
+        {
+          front->next = next->next;
+          link_free (pool, next);
+        }
+      front = next; // move to the next link
+    }
+}
+
+// Copies `x` into one new pool that has room for exactly its dummy link and links, taken in list order, so neighbours
+// in the list are next to each other in memory. The new pool goes to `slab`; as with list_from_array(),
+// free_link_pool() frees the whole new list. `x`, dummy link included, goes back to `pool`.
+// Returns the new list, or NULL if there is not enough memory, leaving `x` as it is.
+List
+list_compact (LinkPool *pool, LinkPool **slab, List x)
+{
+  size_t n = 0;
+  for (Link *link = x->next; link; link = link->next)
+    {
+      n++;
+    }
+  *slab = new_link_pool (n + 1);
+  if (!*slab)
+    {
+      return NULL;
+    }
+
+  // the new pool has room for the dummy link and every link: no allocation below fails
+  List   y    = new_empty_list (*slab);
+  Link **tail = &y->next; // where to hang the next new link
+  for (Link *link = x->next; link; link = link->next)
+    {
+      *tail = new_link (*slab, link->value, NULL);
+      tail  = &(*tail)->next;
+    }
+
+  free_list (pool, x);
+  return y;
+}
+
+// Values of `x` in one new array; its length goes to `n`. Returns NULL if there is no memory.
+int *
+list_to_array (List x, size_t *n)
+{
+  *n = 0;
+  for (Link *link = x->next; link; link = link->next)
+    {
+      (*n)++;
+    }
+  int *array = malloc (*n * sizeof *array + 1);
+  if (!array)
+    {
+      return NULL;
+    }
+  int *a = array;
+  for (Link *link = x->next; link; link = link->next)
+    {
+      *a++ = link->value;
+    }
+  return array;
+}
+
+// New list with the values of `array`, dummy link and links in one block of memory (a pool with a single subpool).
+// The pool is returned in `pool`; free_link_pool() frees the whole list.
+List
+list_from_array (LinkPool **pool, int n, int array[n])
+{
+  *pool = new_link_pool (n + 1);
+  if (!*pool)
+    {
+      return NULL;
+    }
+  List x = make_list_from_array (*pool, n, array);
+  if (!x)
+    {
+      free_link_pool (*pool);
+      *pool = NULL;
+    }
+  return x;
+}
+
+long
+sum_list (List x)
+{
+  long sum = 0;
+  for (Link *link = x->next; link; link = link->next)
+    {
+      sum += link->value;
+    }
+  return sum;
+}
+
+#define ARRAY_SIZE(a) (sizeof a / sizeof *a)
+#define EH(x, msg)                                                                                                     \
+  ({                                                                                                                   \
+    if (!x)                                                                                                            \
+      {                                                                                                                \
+        perror (msg);                                                                                                  \
+        exit (EXIT_FAILURE);                                                                                           \
+      }                                                                                                                \
+  })
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Build, traverse and free a list of n links, `cycles` times; with malloc() if `use_pool` is false.
+// Build with `make CFLAGS=-O2 11_1_4_pooled-singly-linked-lists`, then run
+// `./11_1_4_pooled-singly-linked-lists 10000000`.
+void
+benchmark (int n, int cycles, bool use_pool)
+{
+  double t_build = 0, t_traverse = 0, t_free = 0;
+  long   sum     = 0;
+
+  for (int c = 0; c < cycles; c++)
+    {
+      clock_t   start = clock ();
+      LinkPool *pool  = NULL;
+      if (use_pool)
+        {
+          pool = new_link_pool (1024);
+          EH (pool, "allocation error");
+        }
+      List x = new_empty_list (pool);
+      EH (x, "allocation error");
+      for (int i = n - 1; i >= 0; i--)
+        {
+          EH (prepend (pool, x, i), "allocation error");
+        }
+      t_build += seconds_since (start);
+
+      start = clock ();
+      sum += sum_list (x);
+      t_traverse += seconds_since (start);
+
+      start = clock ();
+      if (use_pool)
+        {
+          free_link_pool (pool); // the whole list, dummy link included
+        }
+      else
+        {
+          free_list (NULL, x);
+        }
+      t_free += seconds_since (start);
+    }
+
+  printf ("%s %7.3fs  %7.3fs  %7.3fs   (checksum %ld)\n", use_pool ? "pool  " : "malloc", t_build, t_traverse, t_free,
+          sum);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5 };
+  int n       = ARRAY_SIZE (array);
+
+  {
+    // -------------------- Two Lists in one Pool -------------------------------------
+
+    printf ("Two lists in one pool:\n");
+    LinkPool *pool = new_link_pool (4);
+    EH (pool, "allocation error");
+    List x = make_list_from_array (pool, n, array);
+    EH (x, "make list error");
+    List y = make_list_from_array (pool, n, array);
+    EH (y, "make list error");
+    print_list (x);
+    print_list (y);
+
+    delete_value (pool, x, 3);                       // the two links go back to the pool …
+    EH (prepend (pool, y, 0), "prepend list error"); // … and are used again
+    print_list (x);
+    print_list (y);
+
+    free_link_pool (pool); // frees x and y
+  }
+
+  {
+    // -------------------- List without Pool -----------------------------------------
+
+    printf ("\nList without pool:\n");
+    List x = make_list_from_array (NULL, n, array);
+    EH (x, "make list error");
+    delete_value (NULL, x, 1);
+    print_list (x);
+    free_list (NULL, x);
+  }
+
+  {
+    // -------------------- Compaction ------------------------------------------------
+
+    printf ("\nCompaction:\n");
+    List x = make_list_from_array (NULL, n, array);
+    EH (x, "make list error");
+    LinkPool *slab;
+    x = list_compact (NULL, &slab, x);
+    EH (x, "allocation error");
+    print_list (x);
+
+    size_t len;
+    int   *values = list_to_array (x, &len);
+    EH (values, "allocation error");
+    free_link_pool (slab); // the whole list, dummy link included
+
+    LinkPool *pool;
+    List      y = list_from_array (&pool, len, values);
+    EH (y, "make list error");
+    print_list (y);
+    free (values);
+    free_link_pool (pool); // frees y, dummy link included
+  }
+
+  if (argc > 1)
+    {
+      int size = atoi (argv[1]);
+      printf ("\nBuild, traverse and free %d links, 3 times\n", size);
+      printf ("         build  traverse     free\n");
+      benchmark (size, 3, false);
+      benchmark (size, 3, true);
+    }
+}
@@ -1,6 +1,7 @@
 #include "list.h"
 #include <assert.h>
 #include <stdio.h>
+#include <time.h>
 
 bool
 is_sorted (List lst)
@@ -174,6 +175,125 @@ merge_sort (List lst1)
   merge (lst1, &lst2);
 }
 
+// -- Natural merge sort -------------------------------------------------------------------------------------------- //
+
+// Bottom-up and without recursion. While sorting, the links form a NULL-terminated chain that only uses `next`;
+// the `prev` pointers are repaired in one pass at the end.
+
+#define MAX_BINS 64 // bin i holds about 2^i runs, so 64 bins are enough for any list that fits in memory
+
+// Merge two NULL-terminated chains. On ties links from `a` come first, so `a` must hold the earlier links (stable).
+Link *
+merge_chains (Link *a, Link *b)
+{
+  Link  *merged = NULL;
+  Link **tail   = &merged;
+
+  while (a && b)
+    {
+      if (a->value <= b->value)
+        {
+          *tail = a;
+          a     = a->next;
+        }
+      else
+        {
+          *tail = b;
+          b     = b->next;
+        }
+      tail = &(*tail)->next;
+    }
+  *tail = a ? a : b;
+  return merged;
+}
+
+// Cut the longest run from the front of the chain `*p` and return it as a sorted chain.
+// Runs are non-decreasing or strictly decreasing (only those can be reversed without breaking stability).
+Link *
+take_run (Link **p)
+{
+  Link *run = *p;
+  Link *end = run; // last link of the run
+
+  if (end->next && end->next->value < end->value)
+    {
+      // descending: reverse while we walk
+      Link *reversed = NULL;
+      Link *q        = run;
+      do
+        {
+          Link *next = q->next;
+          q->next    = reversed;
+          reversed   = q;
+          q          = next;
+        }
+      while (q && q->value < reversed->value);
+      *p = q;
+      return reversed;
+    }
+
+  while (end->next && end->next->value >= end->value)
+    {
+      end = end->next;
+    }
+  *p        = end->next;
+  end->next = NULL;
+  return run;
+}
+
+// 1. Cut the list into natural runs.
+// 2. Add each run to the bins like adding one to a binary counter: merge with bin 0, the result with bin 1, ...
+// 3. Merge the bins.
+// 4. Rebuild the `prev` pointers.
+void
+natural_merge_sort (List lst)
+{
+  if (is_empty (lst))
+    {
+      return;
+    }
+
+  Link *bins[MAX_BINS] = { NULL };
+  int   used_bins      = 0;
+  Link *rest           = front (lst);
+  last (lst)->next     = NULL; // turn the circular list into a chain
+
+  while (rest)
+    {
+      Link *run = take_run (&rest);
+      int   i   = 0;
+      for (; i < used_bins && bins[i]; i++)
+        {
+          run     = merge_chains (bins[i], run); // bins hold earlier links than `run`
+          bins[i] = NULL;
+        }
+      assert (i < MAX_BINS);
+      bins[i] = run;
+      if (i == used_bins)
+        {
+          used_bins++;
+        }
+    }
+
+  Link *sorted = NULL;
+  for (int i = 0; i < used_bins; i++)
+    {
+      if (bins[i])
+        {
+          sorted = merge_chains (bins[i], sorted); // higher bins hold earlier links
+        }
+    }
+
+  Link *prev = lst;
+  for (Link *p = sorted; p; p = p->next)
+    {
+      p->prev = prev;
+      prev    = p;
+    }
+  lst->next = sorted;
+  connect (prev, lst);
+}
+
 // -- Quick sort ---------------------------------------------------------------------------------------------------- //
 
 // Move all items > pivotVal in lst1 to lst2 (initially empty).
@@ -244,37 +364,59 @@ random_list (int n)
   return lst;
 }
 
-void
-test_sorting (int n)
+// Checks that every `prev` is the inverse of a `next`.
+bool
+has_valid_links (List lst)
 {
-  typedef void (*SortFun) (List);
-
-  typedef struct sortfn_name
-  {
-    SortFun sort_fun;
-    char   *sort_name;
-  } SortfnName;
+  Link *p = lst;
+  do
+    {
+      if (p->next->prev != p)
+        {
+          return false;
+        }
+      p = p->next;
+    }
+  while (p != lst);
+  return true;
+}
 
-  SortfnName sort_funs[] = {
-    { selection_sort, "Selection " },
-    { insertion_sort, "Insertion " },
-    { merge_sort, "Merge     " },
-    { quick_sort, "Quick     " },
-  };
+typedef void (*SortFun) (List);
 
-  size_t n_funs = sizeof sort_funs / sizeof *sort_funs;
+typedef struct sortfn_name
+{
+  SortFun sort_fun;
+  char   *sort_name;
+  bool    quadratic_on_sorted; // too slow (quick sort: too deep a recursion) for large sorted input
+  bool    quadratic;           // too slow for large input, period
+} SortfnName;
+
+SortfnName sort_funs[] = {
+  { selection_sort, "Selection ", true, true },
+  { insertion_sort, "Insertion ", true, true },
+  { merge_sort, "Merge     ", false, false },
+  { quick_sort, "Quick     ", true, false },
+  { natural_merge_sort, "Natural   ", false, false },
+};
+
+#define N_SORT_FUNS   (sizeof sort_funs / sizeof *sort_funs)
+#define QUADRATIC_MAX 20000 // largest input we give to an O(n^2) sort in the benchmark
 
+void
+test_sorting (int n)
+{
   List x = random_list (n);
   printf ("Original  ");
   print_list (x);
 
-  for (size_t i = 0; i < n_funs; i++)
+  for (size_t i = 0; i < N_SORT_FUNS; i++)
     {
       List y = copy_list (x);
       sort_funs[i].sort_fun (y);
       printf ("%s", sort_funs[i].sort_name);
       print_list (y);
       assert (is_sorted (y));
+      assert (has_valid_links (y));
       free_list (y);
     }
 
@@ -282,8 +424,88 @@ test_sorting (int n)
   free_list (x);
 }
 
+// -- Benchmark ----------------------------------------------------------------------------------------------------- //
+
+// Build with `make clean; make CFLAGS=-O2\ -DNDEBUG` (no sanitizer, no debug output), then run
+// `./11_2_2_sorting 10000000`.
+
+typedef enum
+{
+  RANDOM,
+  SORTED,
+  REVERSED,
+} Input;
+
+List
+bench_list (int n, Input input)
+{
+  List lst = new_list ();
+  if (!lst)
+    {
+      abort ();
+    }
+
+  for (int i = 0; i < n; i++)
+    {
+      int val = input == RANDOM ? rand () : input == SORTED ? i : n - i;
+      if (!append (lst, val))
+        {
+          abort ();
+        }
+    }
+  return lst;
+}
+
+void
+benchmark_sorting (int n)
+{
+  char *input_names[] = { "random", "sorted", "reversed" };
+
+  printf ("Sorting %d links\n", n);
+  printf ("            random      sorted    reversed\n");
+
+  List inputs[] = { bench_list (n, RANDOM), bench_list (n, SORTED), bench_list (n, REVERSED) };
+
+  for (size_t i = 0; i < N_SORT_FUNS; i++)
+    {
+      printf ("%s", sort_funs[i].sort_name);
+      for (size_t k = 0; k < sizeof inputs / sizeof *inputs; k++)
+        {
+          bool too_slow = (n > QUADRATIC_MAX)
+                          && (sort_funs[i].quadratic || (k != RANDOM && sort_funs[i].quadratic_on_sorted));
+          if (too_slow)
+            {
+              printf ("   (skipped)");
+              continue;
+            }
+
+          List y = copy_list (inputs[k]);
+          if (!y)
+            {
+              abort ();
+            }
+          clock_t start = clock ();
+          sort_funs[i].sort_fun (y);
+          double secs = (double)(clock () - start) / CLOCKS_PER_SEC;
+          printf ("  %9.3fs", secs);
+          if (!is_sorted (y) || !has_valid_links (y))
+            {
+              printf ("\n%s sort failed on %s input\n", sort_funs[i].sort_name, input_names[k]);
+              abort ();
+            }
+          free_list (y);
+        }
+      printf ("\n");
+    }
+
+  for (size_t k = 0; k < sizeof inputs / sizeof *inputs; k++)
+    {
+      free_list (inputs[k]);
+    }
+}
+
 int
-main ()
+main (int argc, char *argv[])
 {
   unsigned random_seed;
   FILE    *fp = fopen ("/dev/urandom", "r");
@@ -291,4 +513,9 @@ main ()
   fclose (fp);
   srand (random_seed);
   test_sorting (20);
+
+  if (argc > 1)
+    {
+      benchmark_sorting (atoi (argv[1]));
+    }
 }
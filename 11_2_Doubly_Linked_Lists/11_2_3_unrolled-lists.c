@@ -0,0 +1,182 @@
+#include "list.h"
+#include "ulist.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ARRAY_SIZE(a) (sizeof a / sizeof *a)
+
+// Error Handling
+#define EH(x, msg)                                                                                                     \
+  ({                                                                                                                   \
+    if (!x)                                                                                                            \
+      {                                                                                                                \
+        perror (msg);                                                                                                  \
+        exit (EXIT_FAILURE);                                                                                           \
+      }                                                                                                                \
+  })
+
+#define c(v) ul_contains (x, v) ? "✓" : "✗"
+
+// Time `contains` on a List and a UList holding the same n values. We search for a value that isn't there, so every
+// search walks the whole list.
+// Build with `make clean; make CFLAGS=-O2\ -DNDEBUG` (no sanitizer, no debug output), then run
+// `./11_2_3_unrolled-lists 10000000`.
+void
+benchmark_contains (int n, int searches)
+{
+  int *array = malloc (n * sizeof *array);
+  EH (array, "allocation error");
+  for (int i = 0; i < n; i++)
+    {
+      array[i] = rand () % n;
+    }
+
+  List  x = make_list_from_array (n, array);
+  UList y = ul_make_list_from_array (n, array);
+  EH (x, "make list error");
+  EH (y, "make list error");
+  free (array);
+
+  int     found = 0;
+  clock_t start = clock ();
+  for (int i = 0; i < searches; i++)
+    {
+      found += contains (x, -1);
+    }
+  double t_list = (double)(clock () - start) / CLOCKS_PER_SEC;
+
+  start = clock ();
+  for (int i = 0; i < searches; i++)
+    {
+      found += ul_contains (y, -1);
+    }
+  double t_ulist = (double)(clock () - start) / CLOCKS_PER_SEC;
+  assert (!found);
+
+  printf ("%d searches in %d values\n", searches, n);
+  printf ("List:  %7.3fs\n", t_list);
+  printf ("UList: %7.3fs (%.1fx)\n", t_ulist, t_list / t_ulist);
+
+  free_list (x);
+  ul_free_list (y);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13 };
+  int n       = ARRAY_SIZE (array);
+
+  {
+    // -------------------- Contains ----------------------------------------
+
+    printf ("\33[38;5;206mContains\033[0m\n");
+    UList x = ul_make_list_from_array (n, array);
+    EH (x, "make list error");
+    ul_print_links (x);
+    printf ("%d %d %d\n", 0, 3, 13);
+    printf ("%s %s %s\n", c (0), c (3), c (13));
+    ul_free_list (x);
+  }
+
+  {
+    // -------------------- Prepend/Append/Insert ---------------------------
+
+    printf ("\33[38;5;206mPrepend 0/Append 14/Insert 100 at 3:\033[0m\n");
+    UList x = ul_make_list_from_array (n, array);
+    EH (x, "make list error");
+    ul_print_links (x);
+    EH (ul_prepend (x, 0), "prepend list error");
+    EH (ul_append (x, 14), "append list error");
+    EH (ul_insert_at (x, 3, 100), "insert list error"); // splits the full first link
+    ul_print_links (x);
+    ul_print_list (x);
+    ul_free_list (x);
+  }
+
+  {
+    // -------------------- Concatenate -------------------------------------
+
+    printf ("\33[38;5;206mConcatenate:\033[0m\n");
+    UList x = ul_make_list_from_array (n, array);
+    UList y = ul_make_list_from_array (3, array);
+    EH (x, "make list error");
+    EH (y, "make list error");
+    ul_concatenate (x, y);
+    assert (ul_is_empty (y));
+    ul_print_links (x);
+    ul_print_links (y);
+    ul_free_list (x);
+    ul_free_list (y);
+  }
+
+  {
+    // -------------------- Deleting values ---------------------------------
+
+    printf ("\33[38;5;206mDeleting values (links are merged):\033[0m\n");
+    UList x = ul_make_list_from_array (n, array);
+    EH (x, "make list error");
+    ul_print_links (x);
+    for (int v = 1; v <= 5; v++)
+      {
+        ul_delete_value (x, v);
+        ul_print_links (x);
+      }
+    ul_free_list (x);
+  }
+
+  {
+    // -------------------- Reversing ---------------------------------------
+
+    printf ("\33[38;5;206mReversing:\033[0m\n");
+    UList x = ul_make_list_from_array (n, array);
+    EH (x, "make list error");
+    ul_print_links (x);
+    ul_reverse (x);
+    ul_print_links (x);
+    ul_free_list (x);
+  }
+
+  {
+    // -------------------- List on Stack -----------------------------------
+
+    printf ("\33[38;5;206mList on Stack:\033[0m\n");
+    UListHead head = ul_init_list_head (head);
+    ul_print_list (&head);
+    ul_append (&head, 1);
+    ul_append (&head, 2);
+    ul_print_list (&head);
+    ul_free_links (&head);
+  }
+
+  {
+    // -------------------- Copy List ---------------------------------------
+
+    printf ("\33[38;5;206mCopy List:\033[0m\n");
+    UList x = ul_make_list_from_array (n, array);
+    UList z = ul_new_list ();
+    EH (x, "make list error");
+    EH (z, "make list error");
+    for (int i = n - 1; i >= 0; i--)
+      {
+        EH (ul_prepend (z, array[i]), "prepend list error"); // z gets differently filled links than x
+      }
+    ul_print_links (x);
+    ul_print_links (z);
+    assert (ul_equal (x, z));
+    ul_free_list (z);
+    z = ul_copy_list (x);
+    EH (z, "copy list error");
+    ul_delete_value (z, 5);
+    ul_print_list (x);
+    ul_print_list (z);
+    assert (!ul_equal (x, z));
+    ul_free_list (x);
+    ul_free_list (z);
+  }
+
+  if (argc > 1)
+    {
+      benchmark_contains (atoi (argv[1]), 20);
+    }
+}
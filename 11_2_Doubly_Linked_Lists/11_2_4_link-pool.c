@@ -0,0 +1,135 @@
+#include "linkpool.h"
+#include "list.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ARRAY_SIZE(a) (sizeof a / sizeof *a)
+
+// Error Handling
+#define EH(x, msg)                                                                                                     \
+  ({                                                                                                                   \
+    if (!x)                                                                                                            \
+      {                                                                                                                \
+        perror (msg);                                                                                                  \
+        exit (EXIT_FAILURE);                                                                                           \
+      }                                                                                                                \
+  })
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+long
+sum_list (List x)
+{
+  long sum = 0;
+  for (Link *link = front (x); link != x; link = link->next)
+    {
+      sum += link->value;
+    }
+  return sum;
+}
+
+// Build, traverse and free a list of n links, `cycles` times; with malloc() if `use_pool` is false.
+// Build with `make clean; make CFLAGS=-O2\ -DNDEBUG` (no sanitizer, no debug output), then run
+// `./11_2_4_link-pool 10000000`.
+void
+benchmark (int n, int cycles, bool use_pool)
+{
+  double t_build = 0, t_traverse = 0, t_free = 0;
+  long   sum     = 0;
+
+  for (int c = 0; c < cycles; c++)
+    {
+      clock_t   start = clock ();
+      LinkPool *pool  = NULL;
+      if (use_pool)
+        {
+          pool = new_link_pool (1024);
+          EH (pool, "allocation error");
+        }
+      List x = new_list_in (pool);
+      EH (x, "allocation error");
+      for (int i = 0; i < n; i++)
+        {
+          EH (append_in (pool, x, i), "allocation error");
+        }
+      t_build += seconds_since (start);
+
+      start = clock ();
+      sum += sum_list (x);
+      t_traverse += seconds_since (start);
+
+      start = clock ();
+      if (use_pool)
+        {
+          free_link_pool (pool); // the whole list, head included
+        }
+      else
+        {
+          free_list (x);
+        }
+      t_free += seconds_since (start);
+    }
+
+  printf ("%s %7.3fs  %7.3fs  %7.3fs   (checksum %ld)\n", use_pool ? "pool  " : "malloc", t_build, t_traverse, t_free,
+          sum);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5 };
+  int n       = ARRAY_SIZE (array);
+
+  {
+    // -------------------- Lists in a Pool ---------------------------------
+
+    printf ("\33[38;5;206mTwo lists in one pool:\033[0m\n");
+    LinkPool *pool = new_link_pool (4);
+    EH (pool, "allocation error");
+    List x = make_list_from_array_in (pool, n, array);
+    EH (x, "make list error");
+    List y = copy_list_in (pool, x);
+    EH (y, "copy list error");
+    print_list (x);
+    print_list (y);
+
+    delete_value_in (pool, x, 3); // the two links go back to the pool …
+    Link *last_freed = &pool->next_free_link->link;
+    (void)last_freed; // only read by the assert
+    EH (prepend_in (pool, y, 0), "prepend list error"); // … and are used again
+    assert (front (y) == last_freed);
+    print_list (x);
+    print_list (y);
+    assert (contains (y, 3) && !contains (x, 3));
+
+    free_link_pool (pool); // frees x and y
+  }
+
+  {
+    // -------------------- Pool and malloc ---------------------------------
+
+    printf ("\33[38;5;206mCopy of a pooled list to malloc'ed links:\033[0m\n");
+    LinkPool *pool = new_link_pool (16);
+    EH (pool, "allocation error");
+    List x = make_list_from_array_in (pool, n, array);
+    EH (x, "make list error");
+    List y = copy_list (x);
+    EH (y, "copy list error");
+    free_link_pool (pool);
+    print_list (y);
+    free_list (y);
+  }
+
+  if (argc > 1)
+    {
+      int size = atoi (argv[1]);
+      printf ("Build, traverse and free %d links, 3 times\n", size);
+      printf ("         build  traverse     free\n");
+      benchmark (size, 3, false);
+      benchmark (size, 3, true);
+    }
+}
@@ -0,0 +1,220 @@
+#include "list.h"
+#include "skiplist.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define ARRAY_SIZE(a) (sizeof a / sizeof *a)
+
+// Error Handling
+#define EH(x, msg)                                                                                                     \
+  ({                                                                                                                   \
+    if (!x)                                                                                                            \
+      {                                                                                                                \
+        perror (msg);                                                                                                  \
+        exit (EXIT_FAILURE);                                                                                           \
+      }                                                                                                                \
+  })
+
+#define c(v)       sl_contains (x, v) ? "✓" : "✗"
+#define N_THREADS  4
+#define PER_THREAD 10000
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+typedef struct worker_args
+{
+  SkipList *sl;
+  int       first;
+} WorkerArgs;
+
+// Every worker inserts its own values, deletes every other one and looks up the values of its neighbour.
+void *
+worker (void *arg)
+{
+  WorkerArgs *args = arg;
+  for (int i = 0; i < PER_THREAD; i++)
+    {
+      EH (sl_insert (args->sl, args->first + i), "insert error");
+    }
+  for (int i = 0; i < PER_THREAD; i += 2)
+    {
+      bool found = sl_delete (args->sl, args->first + i);
+      assert (found);
+      (void)found;
+    }
+  for (int i = 0; i < PER_THREAD; i++)
+    {
+      sl_contains (args->sl, (args->first + PER_THREAD + i) % (N_THREADS * PER_THREAD));
+    }
+  return NULL;
+}
+
+// Time lookups of values that are not there, so every `contains` on the List walks the whole list.
+// Build with `make clean; make CFLAGS=-O2\ -DNDEBUG` (no sanitizer, no debug output), then run
+// `./11_2_5_skip-lists 1000000`.
+void
+benchmark_lookup (int n)
+{
+  List      x  = new_list ();
+  SkipList *sl = sl_new_list (false);
+  EH (x, "allocation error");
+  EH (sl, "allocation error");
+  for (int i = 0; i < n; i++)
+    {
+      int val = 2 * (rand () % n); // even values only
+      EH (append (x, val), "allocation error");
+      EH (sl_insert (sl, val), "allocation error");
+    }
+
+  int     list_searches = 100;
+  int     found         = 0;
+  clock_t start         = clock ();
+  for (int i = 0; i < list_searches; i++)
+    {
+      found += contains (x, 2 * i + 1);
+    }
+  double t_list = seconds_since (start) / list_searches;
+
+  int sl_searches = n;
+  start           = clock ();
+  for (int i = 0; i < sl_searches; i++)
+    {
+      found += sl_contains (sl, 2 * (rand () % n) + 1);
+    }
+  double t_sl = seconds_since (start) / sl_searches;
+  assert (!found);
+
+  size_t ranks = 0;
+  start        = clock ();
+  for (int i = 0; i < sl_searches; i++)
+    {
+      int val = 0;
+      sl_at (sl, 1 + rand () % sl_length (sl), &val);
+      ranks += sl_rank (sl, val);
+    }
+  double t_rank = seconds_since (start) / sl_searches;
+
+  printf ("Lookups in %d values (%zu distinct in the skip list)\n", n, sl_length (sl));
+  printf ("List:      %10.3fµs per lookup\n", t_list * 1e6);
+  printf ("SkipList:  %10.3fµs per lookup (%.0fx)\n", t_sl * 1e6, t_list / t_sl);
+  printf ("at + rank: %10.3fµs (checksum %zu)\n", t_rank * 1e6, ranks);
+
+  free_list (x);
+  sl_free_list (sl);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 8, 3, 5, 1, 7, 2, 6, 4, 5, 1 };
+  int n       = ARRAY_SIZE (array);
+
+  {
+    // -------------------- Contains ----------------------------------------
+
+    printf ("\33[38;5;206mContains (duplicates are dropped):\033[0m\n");
+    SkipList *x = sl_make_list_from_array (n, array);
+    EH (x, "make list error");
+    sl_print_list (x);
+    sl_print_levels (x);
+    printf ("%d %d %d\n", 0, 3, 9);
+    printf ("%s %s %s\n", c (0), c (3), c (9));
+    sl_free_list (x);
+  }
+
+  {
+    // -------------------- Rank and Select ---------------------------------
+
+    printf ("\33[38;5;206mRank and select:\033[0m\n");
+    SkipList *x = sl_make_list_from_array (n, array);
+    EH (x, "make list error");
+    for (int v = 0; v <= 9; v += 3)
+      {
+        printf ("rank(%d) = %zu\n", v, sl_rank (x, v));
+      }
+    int val;
+    for (size_t k = 1; k <= sl_length (x); k++)
+      {
+        assert (sl_at (x, k, &val) && sl_rank (x, val) == k);
+      }
+    EH (sl_at (x, 4, &val), "at error");
+    printf ("at(4) = %d\n", val);
+    assert (!sl_at (x, 0, &val) && !sl_at (x, sl_length (x) + 1, &val));
+    sl_free_list (x);
+  }
+
+  {
+    // -------------------- Deleting values ---------------------------------
+
+    printf ("\33[38;5;206mDeleting 1, 5, 8 and 9:\033[0m\n");
+    SkipList *x = sl_make_list_from_array (n, array);
+    EH (x, "make list error");
+    sl_delete (x, 1);
+    sl_delete (x, 5);
+    sl_delete (x, 8);
+    sl_delete (x, 9); // not there
+    sl_print_list (x);
+    sl_print_levels (x);
+    sl_free_list (x);
+  }
+
+  {
+    // -------------------- Iterating ---------------------------------------
+
+    printf ("\33[38;5;206mIterating backwards:\033[0m\n");
+    SkipList *x = sl_make_list_from_array (n, array);
+    EH (x, "make list error");
+    for (SLNode *node = sl_last (x); node != x->head; node = sl_prev (node))
+      {
+        printf ("%d ", node->value);
+      }
+    printf ("\n");
+    sl_free_list (x);
+  }
+
+  {
+    // -------------------- Concurrent Mode ---------------------------------
+
+    printf ("\33[38;5;206mConcurrent mode, %d threads:\033[0m\n", N_THREADS);
+    SkipList *x = sl_new_list (true);
+    EH (x, "allocation error");
+    pthread_t  threads[N_THREADS];
+    WorkerArgs args[N_THREADS];
+    for (int t = 0; t < N_THREADS; t++)
+      {
+        args[t] = (WorkerArgs){ .sl = x, .first = t * PER_THREAD };
+        if (pthread_create (&threads[t], NULL, worker, &args[t]))
+          {
+            fprintf (stderr, "pthread_create error\n");
+            exit (EXIT_FAILURE);
+          }
+      }
+    for (int t = 0; t < N_THREADS; t++)
+      {
+        pthread_join (threads[t], NULL);
+      }
+
+    // only the odd values are left
+    size_t k = 0;
+    sl_read_lock (x);
+    sl_for_each (node, x)
+    {
+      assert (node->value == 2 * (int)k + 1);
+      k++;
+    }
+    sl_unlock (x);
+    printf ("%zu values, all odd and in order\n", k);
+    assert (k == sl_length (x) && k == N_THREADS * PER_THREAD / 2);
+    sl_free_list (x);
+  }
+
+  if (argc > 1)
+    {
+      benchmark_lookup (atoi (argv[1]));
+    }
+}
@@ -0,0 +1,207 @@
+#include "linkpool.h"
+#include "list.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ARRAY_SIZE(a) (sizeof a / sizeof *a)
+
+// Error Handling
+#define EH(x, msg)                                                                                                     \
+  ({                                                                                                                   \
+    if (!x)                                                                                                            \
+      {                                                                                                                \
+        perror (msg);                                                                                                  \
+        exit (EXIT_FAILURE);                                                                                           \
+      }                                                                                                                \
+  })
+
+#define N_QUERIES 64
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Relink the links of `x` in random order, so that neighbours in the list are far apart in memory (as in a heap
+// that has seen a lot of allocations and frees). The values move with their links.
+void
+shuffle_links (List x, int n)
+{
+  Link **links = malloc (n * sizeof *links);
+  EH (links, "allocation error");
+  int i = 0;
+  for (Link *link = front (x); link != x; link = link->next)
+    {
+      links[i++] = link;
+    }
+  for (i = n - 1; i > 0; i--)
+    {
+      int   j   = rand () % (i + 1);
+      Link *tmp = links[i];
+      links[i]  = links[j];
+      links[j]  = tmp;
+    }
+  clear_list (x);
+  for (i = 0; i < n; i++)
+    {
+      append_link (x, links[i]);
+    }
+  free (links);
+}
+
+// Time `contains` walking one chain, `contains_prefetch` walking two, and N_QUERIES queries one by one against one
+// `contains_many`. All searched values are missing, so each search walks the whole list.
+// Then compact the list and time `contains` and `contains_prefetch` again.
+// Build with `make clean; make CFLAGS=-O2\ -DNDEBUG` (no sanitizer, no debug output), then run
+// `./11_2_6_prefetch 10000000`.
+void
+benchmark (int n)
+{
+  List x = new_list ();
+  EH (x, "allocation error");
+  for (int i = 0; i < n; i++)
+    {
+      EH (append (x, i), "allocation error");
+    }
+  shuffle_links (x, n);
+
+  int  queries[N_QUERIES];
+  bool out[N_QUERIES];
+  for (int i = 0; i < N_QUERIES; i++)
+    {
+      queries[i] = -1 - i;
+    }
+
+  int     searches = 10;
+  int     found    = 0;
+  clock_t start    = clock ();
+  for (int i = 0; i < searches; i++)
+    {
+      found += contains (x, queries[i]);
+    }
+  double t_contains = seconds_since (start) / searches;
+
+  start = clock ();
+  for (int i = 0; i < searches; i++)
+    {
+      found += contains_prefetch (x, queries[i]);
+    }
+  double t_prefetch = seconds_since (start) / searches;
+
+  start = clock ();
+  EH (contains_many (x, queries, N_QUERIES, out), "allocation error");
+  double t_many = seconds_since (start);
+  for (int i = 0; i < N_QUERIES; i++)
+    {
+      found += out[i];
+    }
+  assert (!found);
+
+  printf ("One search in %d shuffled links\n", n);
+  printf ("contains:          %7.3fs\n", t_contains);
+  printf ("contains_prefetch: %7.3fs (%.1fx)\n", t_prefetch, t_contains / t_prefetch);
+  printf ("%d searches\n", N_QUERIES);
+  printf ("contains:          %7.3fs (estimated)\n", N_QUERIES * t_contains);
+  printf ("contains_many:     %7.3fs (%.1fx)\n", t_many, N_QUERIES * t_contains / t_many);
+
+  start = clock ();
+  LinkPool *slab;
+  x = list_compact (&slab, x);
+  EH (x, "allocation error");
+  double t_compact = seconds_since (start);
+
+  start = clock ();
+  for (int i = 0; i < searches; i++)
+    {
+      found += contains (x, queries[i]);
+    }
+  double t_contains_compact = seconds_since (start) / searches;
+
+  start = clock ();
+  for (int i = 0; i < searches; i++)
+    {
+      found += contains_prefetch (x, queries[i]);
+    }
+  double t_prefetch_compact = seconds_since (start) / searches;
+  assert (!found);
+
+  printf ("After list_compact (%.3fs)\n", t_compact);
+  printf ("contains:          %7.3fs (%.1fx)\n", t_contains_compact, t_contains / t_contains_compact);
+  printf ("contains_prefetch: %7.3fs (%.1fx)\n", t_prefetch_compact, t_contains / t_prefetch_compact);
+
+  free_link_pool (slab); // the whole list, head included
+}
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5 };
+  int n       = ARRAY_SIZE (array);
+
+  {
+    // -------------------- Contains ----------------------------------------
+
+    printf ("\33[38;5;206mContains (with prefetching):\033[0m\n");
+    List x = make_list_from_array (n, array);
+    EH (x, "make list error");
+    for (int v = 0; v <= 6; v++)
+      {
+        assert (contains_prefetch (x, v) == contains (x, v));
+        printf ("%d %s\n", v, contains_prefetch (x, v) ? "✓" : "✗");
+      }
+    free_list (x);
+  }
+
+  {
+    // -------------------- Contains Many -----------------------------------
+
+    printf ("\33[38;5;206mContains many:\033[0m\n");
+    List x = make_list_from_array (n, array);
+    EH (x, "make list error");
+    int  queries[] = { 6, 5, 0, 5, 1, -3 };
+    bool out[ARRAY_SIZE (queries)];
+    EH (contains_many (x, queries, ARRAY_SIZE (queries), out), "allocation error");
+    for (size_t i = 0; i < ARRAY_SIZE (queries); i++)
+      {
+        assert (out[i] == contains (x, queries[i]));
+        printf ("%d %s\n", queries[i], out[i] ? "✓" : "✗");
+      }
+    free_list (x);
+  }
+
+  {
+    // -------------------- Compaction --------------------------------------
+
+    printf ("\33[38;5;206mCompaction:\033[0m\n");
+    List x = make_list_from_array (n, array);
+    EH (x, "make list error");
+    shuffle_links (x, n);
+    print_list (x);
+    LinkPool *slab;
+    x = list_compact (&slab, x);
+    EH (x, "allocation error");
+    print_list (x);
+    for (Link *link = front (x); link != last (x); link = link->next)
+      {
+        assert (link->next == link + 1); // neighbours in memory
+      }
+
+    size_t len;
+    int   *values = list_to_array (x, &len);
+    EH (values, "allocation error");
+    free_link_pool (slab); // frees x, head included
+
+    LinkPool *pool;
+    List      y = list_from_array (&pool, len, values);
+    EH (y, "make list error");
+    print_list (y);
+    free (values);
+    free_link_pool (pool); // frees y, head included
+  }
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]));
+    }
+}
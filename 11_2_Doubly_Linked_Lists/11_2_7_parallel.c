@@ -0,0 +1,194 @@
+#include "linkpool.h"
+#include "list.h"
+#include "plist.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ARRAY_SIZE(a) (sizeof a / sizeof *a)
+
+// Error Handling
+#define EH(x, msg)                                                                                                     \
+  ({                                                                                                                   \
+    if (!x)                                                                                                            \
+      {                                                                                                                \
+        perror (msg);                                                                                                  \
+        exit (EXIT_FAILURE);                                                                                           \
+      }                                                                                                                \
+  })
+
+int
+square (int val, void *arg)
+{
+  (void)arg;
+  return val * val;
+}
+
+bool
+is_odd (int val, void *arg)
+{
+  (void)arg;
+  return val % 2;
+}
+
+long
+identity (int val, void *arg)
+{
+  (void)arg;
+  return val;
+}
+
+long
+add (long x, long y)
+{
+  return x + y;
+}
+
+// Some heavy work per value: `*rounds` rounds of a hash function.
+int
+hash (int val, void *arg)
+{
+  int      rounds = *(int *)arg;
+  unsigned h      = val;
+  for (int i = 0; i < rounds; i++)
+    {
+      h ^= h >> 16;
+      h *= 0x45d9f3b;
+    }
+  return h & 0x7fffffff;
+}
+
+bool
+is_even_hash (int val, void *arg)
+{
+  return hash (val, arg) % 2 == 0;
+}
+
+// Wall clock time; clock() adds up the time of all threads.
+double
+now (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Map, filter and reduce n values with `rounds` rounds of hashing per value, on 1, 2, 4, … `max_threads` threads.
+// Build with `make clean; make CFLAGS=-O2\ -DNDEBUG` (no sanitizer, no debug output), then run
+// `./11_2_7_parallel 1000000 16`.
+void
+benchmark (int n, int max_threads)
+{
+  int rounds = 200;
+  printf ("%d values, %d rounds of hashing per value\n", n, rounds);
+  printf ("threads       map    filter    reduce\n");
+  long expected = 0;
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+      List x = new_list ();
+      EH (x, "allocation error");
+      for (int i = 0; i < n; i++)
+        {
+          EH (append (x, i), "allocation error");
+        }
+      ThreadPool *pool = new_thread_pool (threads);
+      EH (pool, "allocation error");
+
+      long   sum;
+      double start = now ();
+      EH (list_map_par (pool, x, hash, &rounds), "allocation error");
+      double t_map = now () - start;
+      start        = now ();
+      EH (list_filter_par (pool, x, is_even_hash, &rounds), "allocation error");
+      double t_filter = now () - start;
+      start           = now ();
+      EH (list_reduce_par (pool, x, identity, add, 0, NULL, &sum), "allocation error");
+      double t_reduce = now () - start;
+
+      expected = (threads == 1) ? sum : expected;
+      assert (sum == expected);
+      printf ("%7d %8.3fs %8.3fs %8.3fs   (checksum %ld)\n", threads, t_map, t_filter, t_reduce, sum);
+      free_thread_pool (pool);
+      free_list (x);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13 };
+  int n       = ARRAY_SIZE (array);
+
+  ThreadPool *pool = new_thread_pool (4);
+  EH (pool, "allocation error");
+
+  {
+    // -------------------- Segments ----------------------------------------
+
+    printf ("\33[38;5;206mCutting into 4 segments:\033[0m\n");
+    List x = make_list_from_array (n, array);
+    EH (x, "make list error");
+    Link *starts[5];
+    int   m = cut_list (x, 4, starts);
+    for (int i = 0; i < m; i++)
+      {
+        printf ("[ ");
+        for (Link *link = starts[i]; link != starts[i + 1]; link = link->next)
+          {
+            printf ("%d ", link->value);
+          }
+        printf ("] ");
+      }
+    printf ("\n");
+    free_list (x);
+  }
+
+  {
+    // -------------------- Map, Filter, Reduce -----------------------------
+
+    printf ("\33[38;5;206mSquares, odd ones only, and their sum:\033[0m\n");
+    List x = make_list_from_array (n, array);
+    EH (x, "make list error");
+    EH (list_map_par (pool, x, square, NULL), "map error");
+    print_list (x);
+    EH (list_filter_par (pool, x, is_odd, NULL), "filter error");
+    print_list (x);
+    long sum;
+    EH (list_reduce_par (pool, x, identity, add, 0, NULL, &sum), "reduce error");
+    printf ("%ld\n", sum);
+    assert (sum == 1 + 9 + 25 + 49 + 81 + 121 + 169);
+    free_list (x);
+  }
+
+  {
+    // -------------------- Links from a Pool -------------------------------
+
+    printf ("\33[38;5;206mOdd ones only, links from a pool:\033[0m\n");
+    LinkPool *links = new_link_pool (n + 1);
+    EH (links, "allocation error");
+    List x = make_list_from_array_in (links, n, array);
+    EH (x, "make list error");
+    EH (list_filter_par_in (links, pool, x, is_odd, NULL), "filter error");
+    print_list (x);
+    free_list_in (links, x);
+    free_link_pool (links);
+  }
+
+  {
+    // -------------------- Empty List --------------------------------------
+
+    List x = new_list ();
+    EH (x, "allocation error");
+    long sum = -1;
+    EH (list_filter_par (pool, x, is_odd, NULL), "filter error");
+    EH (list_reduce_par (pool, x, identity, add, 0, NULL, &sum), "reduce error");
+    assert (is_empty (x) && sum == 0);
+    free_list (x);
+  }
+
+  free_thread_pool (pool);
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]), argc > 2 ? atoi (argv[2]) : 8);
+    }
+}
@@ -0,0 +1,98 @@
+#include "linkpool.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// `next_subpool` is an existing subpool or NULL.
+static LinkSubpool *
+new_subpool (size_t capacity, LinkSubpool *next_subpool)
+{
+  LinkSubpool *sp = malloc (offsetof (LinkSubpool, links) + (sizeof *sp->links) * capacity);
+  if (!sp)
+    {
+      return NULL;
+    }
+  sp->next_subpool = next_subpool;
+  return sp;
+}
+
+// Creates new `LinkPool` with initial `capacity` (at least 1).
+LinkPool *
+new_link_pool (size_t capacity)
+{
+  LinkPool *pool = malloc (sizeof *pool);
+  if (!pool)
+    {
+      return NULL;
+    }
+  capacity        = capacity ? capacity : 1;
+  LinkSubpool *sp = new_subpool (capacity, NULL);
+  if (!sp)
+    {
+      free (pool);
+      return NULL;
+    }
+
+  pool->capacity       = capacity;
+  pool->next_free_link = NULL;
+  pool->next_unused    = sp->links;
+  pool->end_unused     = sp->links + capacity;
+  pool->subpool        = sp;
+
+  return pool;
+}
+
+// Frees all links that came from `pool`, in O(number of subpools).
+void
+free_link_pool (LinkPool *pool)
+{
+  LinkSubpool *sp = pool->subpool;
+  while (sp)
+    {
+      LinkSubpool *next = sp->next_subpool;
+      free (sp);
+      sp = next;
+    }
+  free (pool);
+}
+
+// Get link from pool: a link given back earlier, or the next unused one, or one from a new subpool.
+Link *
+link_alloc (LinkPool *pool)
+{
+  if (pool->next_free_link)
+    {
+      Link *link           = &pool->next_free_link->link;
+      pool->next_free_link = pool->next_free_link->next_free_link;
+      return link;
+    }
+
+  if (pool->next_unused == pool->end_unused)
+    {
+      // add a pool twice as large as the current largest pool - if we can.
+      if (SIZE_MAX / 2 / sizeof (LinkFreeList) < pool->capacity)
+        {
+          return NULL;
+        }
+      size_t       new_size = 2 * pool->capacity;
+      LinkSubpool *sp       = new_subpool (new_size, pool->subpool);
+      if (!sp)
+        {
+          return NULL;
+        }
+      // add new sub pool to pool
+      pool->capacity    = new_size;
+      pool->next_unused = sp->links;
+      pool->end_unused  = sp->links + new_size;
+      pool->subpool     = sp;
+    }
+  return &pool->next_unused++->link;
+}
+
+// Give link back to pool.
+void
+link_free (LinkPool *pool, Link *link)
+{
+  LinkFreeList *free_list    = (LinkFreeList *)link;
+  free_list->next_free_link = pool->next_free_link;
+  pool->next_free_link      = free_list;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "list.h"
+#include <stddef.h>
+
+// A pool of links for the lists in list.h; it is the node pool from 16_Allocation_Pools/16_3_node_pool-free.c
+// with `Link` in place of the tree `node`.
+//
+// Links are handed out from subpools, i.e., arrays of links, so the links of a list that is built from one pool sit
+// next to each other in memory. Links given back with link_free() are kept on a free list and reused first.
+// Unlike 16_3, a new subpool isn't threaded onto the free list up front; its links are handed out in order
+// (`next_unused` up to `end_unused`), so a fresh subpool is only touched as it is used.
+// free_link_pool() releases all links of all lists in the pool with one free() per subpool, without walking the
+// lists.
+
+// basically a link; but if a link is not used, will contain a pointer to the next free link
+typedef union link_free_list
+{
+  union link_free_list *next_free_link;
+  Link                  link;
+} LinkFreeList;
+
+// linked list of subpools; each subpool contains an array of links
+typedef struct link_subpool
+{
+  struct link_subpool *next_subpool; // linked list of subpools
+  LinkFreeList         links[];      // flexible array member must be at end of struct
+} LinkSubpool;
+
+// a list of subpools and free links
+struct link_pool
+{
+  size_t        capacity;       // capacity of the newest subpool
+  LinkFreeList *next_free_link; // points to first link given back with link_free()
+  LinkFreeList *next_unused;    // next never used link in the newest subpool …
+  LinkFreeList *end_unused;     // … up to here
+  LinkSubpool  *subpool;        // points to begin of subpool linked list
+};
+
+LinkPool *new_link_pool (size_t capacity);
+void      free_link_pool (LinkPool *pool);
+Link     *link_alloc (LinkPool *pool);
+void      link_free (LinkPool *pool, Link *link);
@@ -1,42 +1,73 @@
 #include "list.h"
+#include "linkpool.h"
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 Link *
-new_link (int val, Link *prev, Link *next)
+new_link_in (LinkPool *pool, int val, Link *prev, Link *next)
 {
-  Link *pLink = malloc (sizeof *pLink);
+  Link *pLink = pool ? link_alloc (pool) : malloc (sizeof *pLink);
   if (!pLink)
     {
       return NULL;
     }
-  pLink->value = val;
-  pLink->prev  = prev;
-  pLink->next  = next;
+  pLink->value  = val;
+  pLink->pooled = pool != NULL;
+  pLink->prev   = prev;
+  pLink->next   = next;
   return pLink;
 }
 
+Link *
+new_link (int val, Link *prev, Link *next)
+{
+  return new_link_in (NULL, val, prev, next);
+}
+
+// Counterpart of new_link_in() for a single link.
+void
+free_link_in (LinkPool *pool, Link *x)
+{
+  assert (x->pooled == !!pool); // free() on a pool link, or the other way round, corrupts the heap or the pool
+  if (pool)
+    {
+      link_free (pool, x);
+    }
+  else
+    {
+      free (x);
+    }
+}
+
 // create new empty list (consists only of dummy)
 List
-new_list ()
+new_list_in (LinkPool *pool)
 {
   Link *head;
-  head = new_link (314159, NULL, NULL);
+  head = new_link_in (pool, 314159, NULL, NULL);
   if (!head)
     {
       return NULL;
     }
-  *head = init_list_head (*head); // update next, prev pointers; create head on the stack and copy it to heap
+  clear_head (*head); // update next, prev pointers
 #ifndef NDEBUG
   printf ("[DEBUG] head: %p next: %p prev: %p val: %d\n", head, head->next, head->prev, head->value);
 #endif
   return head;
 }
 
+List
+new_list ()
+{
+  return new_list_in (NULL);
+}
+
 // Free real links, but not head/dummy; result is an empty list.
 // Use free_links() for stack-allocated head.
 // Use free_list()  for lists on the heap.
 void
-free_links (List head)
+free_links_in (LinkPool *pool, List head)
 {
   Link *link = front (head);
   while (link != head)
@@ -45,17 +76,23 @@ free_links (List head)
       printf ("[DEBUG] Freeing link %p, val: %d \n", link, link->value);
 #endif
       Link *next = link->next;
-      free (link);
+      free_link_in (pool, link);
       link = next;
     }
   clear_list (head);
 }
 
+void
+free_links (List head)
+{
+  free_links_in (NULL, head);
+}
+
 // Insert new link after `after` with val `val`.
 bool
-insert_val_after (Link *after, int val)
+insert_val_after_in (LinkPool *pool, Link *after, int val)
 {
-  Link *link = new_link (val, after, after->next);
+  Link *link = new_link_in (pool, val, after, after->next);
   if (!link)
     {
       return false;
@@ -64,10 +101,16 @@ insert_val_after (Link *after, int val)
   return true;
 }
 
+bool
+insert_val_after (Link *after, int val)
+{
+  return insert_val_after_in (NULL, after, val);
+}
+
 List
-make_list_from_array (int n, int array[n])
+make_list_from_array_in (LinkPool *pool, int n, int array[n])
 {
-  List x = new_list ();
+  List x = new_list_in (pool);
   if (!x)
     {
       return NULL;
@@ -75,15 +118,21 @@ make_list_from_array (int n, int array[n])
 
   for (int i = 0; i < n; i++)
     {
-      if (!append (x, array[i]))
+      if (!append_in (pool, x, array[i]))
         {
-          free_list (x);
+          free_list_in (pool, x);
           return NULL;
         } // append after head
     }
   return x;
 }
 
+List
+make_list_from_array (int n, int array[n])
+{
+  return make_list_from_array_in (NULL, n, array);
+}
+
 void
 print_list (List x)
 {
@@ -119,7 +168,7 @@ concatenate (List x, List y)
 }
 
 void
-delete_value (List x, int val)
+delete_value_in (LinkPool *pool, List x, int val)
 {
   Link *link = front (x);
   while (link != x)
@@ -127,12 +176,19 @@ delete_value (List x, int val)
       Link *next = link->next;
       if (link->value == val)
         {
-          delete_link (link);
+          unlink (link);
+          free_link_in (pool, link);
         }
       link = next;
     }
 }
 
+void
+delete_value (List x, int val)
+{
+  delete_value_in (NULL, x, val);
+}
+
 #if 0
 #define swap_int(x, y)                                                                                                 \
   do                                                                                                                   \
@@ -177,10 +233,11 @@ reverse (List x)
 }
 #endif
 
+// The copy's links come from `pool`, whatever `x` was allocated from.
 List
-copy_list (List x)
+copy_list_in (LinkPool *pool, List x)
 {
-  List newlist = new_list ();
+  List newlist = new_list_in (pool);
   if (!newlist)
     {
       return NULL;
@@ -188,9 +245,9 @@ copy_list (List x)
 
   for (Link *p = front (x); p != x; p = p->next)
     {
-      if (!append (newlist, p->value))
+      if (!append_in (pool, newlist, p->value))
         {
-          free_list (newlist);
+          free_list_in (pool, newlist);
           return NULL;
         }
     }
@@ -198,6 +255,12 @@ copy_list (List x)
   return newlist;
 }
 
+List
+copy_list (List x)
+{
+  return copy_list_in (NULL, x);
+}
+
 bool
 equal (List x, List y)
 {
@@ -206,6 +269,8 @@ equal (List x, List y)
 
   while ((p != x) && (q != y))
     {
+      __builtin_prefetch (p->next); // the two lists are independent chains; let both loads run at the same time
+      __builtin_prefetch (q->next);
       if (p->value != q->value)
         {
           return false;
@@ -216,3 +281,186 @@ equal (List x, List y)
 
   return (p == x) && (q == y);
 }
+
+// Like contains(), but walks the list from both ends at once. Following `next` pointers is one chain of dependent
+// loads; every load has to wait until the one before it is done. The walk from the back is a second, independent chain,
+// so the CPU can wait for two cache misses at the same time. The links after the next ones are prefetched as soon as
+// their addresses are known.
+bool
+contains_prefetch (List x, int val)
+{
+  Link *f = front (x); // walks forward
+  Link *b = last (x);  // walks backward
+  while (f != x)
+    {
+      Link *f_next = f->next;
+      Link *b_prev = b->prev;
+      __builtin_prefetch (f_next);
+      __builtin_prefetch (b_prev);
+      if (f->value == val || b->value == val)
+        {
+          return true;
+        }
+      if (f == b || f_next == b) // met in the middle
+        {
+          break;
+        }
+      f = f_next;
+      b = b_prev;
+    }
+  return false;
+}
+
+static int
+cmp_ints (const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// Index of `val` in sorted `vals` or -1.
+static long
+bsearch_index (int val, const int *vals, size_t k)
+{
+  size_t lo = 0;
+  size_t hi = k;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (vals[mid] < val)
+        {
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+  return (lo < k && vals[lo] == val) ? (long)lo : -1;
+}
+
+// Answers k membership queries with one pass over the list instead of k passes: out[i] is set to contains (x, vals[i]).
+// The queries are sorted, so every link costs a binary search over them; the walk stops as soon as all are answered.
+// Returns false if there is no memory for the sorted copy of the queries (or k is too large for one).
+bool
+contains_many (List x, int *vals, size_t k, bool *out)
+{
+  if (k > (SIZE_MAX - 1) / (sizeof (int) + sizeof (bool)))
+    {
+      return false;
+    }
+  int *sorted = malloc (k * (sizeof *sorted + sizeof (bool)) + 1);
+  if (!sorted)
+    {
+      return false;
+    }
+  bool *found = (bool *)(sorted + k);
+  memcpy (sorted, vals, k * sizeof *vals);
+  qsort (sorted, k, sizeof *sorted, cmp_ints);
+
+  // remove duplicates
+  size_t distinct = 0;
+  for (size_t i = 0; i < k; i++)
+    {
+      if (distinct == 0 || sorted[i] != sorted[distinct - 1])
+        {
+          sorted[distinct++] = sorted[i];
+        }
+    }
+  memset (found, false, distinct);
+
+  size_t n_found = 0;
+  for (Link *link = front (x); link != x && n_found < distinct; link = link->next)
+    {
+      long i = bsearch_index (link->value, sorted, distinct);
+      if (i >= 0 && !found[i])
+        {
+          found[i] = true;
+          n_found++;
+        }
+    }
+
+  for (size_t i = 0; i < k; i++)
+    {
+      out[i] = found[bsearch_index (vals[i], sorted, distinct)];
+    }
+  free (sorted);
+  return true;
+}
+
+// Copies `x` into one new pool that has room for exactly its head and links, taken in list order, so the list ends up
+// in one contiguous block of memory with neighbours in the list next to each other. The new pool goes to `slab`; as
+// with list_from_array(), free_link_pool() frees the whole new list, head included. `x`, head and links, goes back to
+// `pool` (NULL means free()). Returns the new list, or NULL if there is not enough memory, leaving `x` as it is.
+List
+list_compact_in (LinkPool *pool, LinkPool **slab, List x)
+{
+  size_t n = 0;
+  for (Link *p = front (x); p != x; p = p->next)
+    {
+      n++;
+    }
+  *slab = new_link_pool (n + 1);
+  if (!*slab)
+    {
+      return NULL;
+    }
+
+  // the new pool has room for the head and every link: no allocation below fails
+  List y = new_list_in (*slab);
+  for (Link *p = front (x); p != x; p = p->next)
+    {
+      append_in (*slab, y, p->value);
+    }
+
+  free_list_in (pool, x);
+  return y;
+}
+
+List
+list_compact (LinkPool **slab, List x)
+{
+  return list_compact_in (NULL, slab, x);
+}
+
+// Values of `x` in one new array; its length goes to `n`. Returns NULL if there is no memory.
+int *
+list_to_array (List x, size_t *n)
+{
+  *n = 0;
+  for (Link *p = front (x); p != x; p = p->next)
+    {
+      (*n)++;
+    }
+  int *array = malloc (*n * sizeof *array + 1);
+  if (!array)
+    {
+      return NULL;
+    }
+  int *a = array;
+  for (Link *p = front (x); p != x; p = p->next)
+    {
+      *a++ = p->value;
+    }
+  return array;
+}
+
+// New list with the values of `array`, head and links in one block of memory (a pool with a single subpool).
+// The pool is returned in `pool`; free_link_pool() frees the whole list.
+List
+list_from_array (LinkPool **pool, int n, int array[n])
+{
+  *pool = new_link_pool (n + 1);
+  if (!*pool)
+    {
+      return NULL;
+    }
+  List x = make_list_from_array_in (*pool, n, array);
+  if (!x)
+    {
+      free_link_pool (*pool);
+      *pool = NULL;
+    }
+  return x;
+}
@@ -36,6 +36,7 @@
 typedef struct link
 {
   int          value;
+  bool         pooled; // taken from a LinkPool; checked in debug builds when the link is freed
   struct link *prev;
   struct link *next;
 } Link;
@@ -43,42 +44,73 @@ typedef struct link
 typedef Link      ListHead; // ListHead is a link, the dummy link.
 typedef ListHead *List;     // List is a pointer to the head/dummy link.
 
-Link   *new_link (int val, Link *prev, Link *next);
-List    new_list ();
-List    make_list_from_array (int n, int array[n]);
-bool    insert_val_after (Link *after, int val);
-void    free_links (List head);
-void    print_list (List x);
-bool    contains (List x, int val);
-void    concatenate (List x, List y);
-void    delete_value (List x, int val);
-void    reverse (List x);
-List    copy_list (List x);
-bool    equal (List x, List y);
-SI void connect (Link *x, Link *y);
-SI void connect_neighbours (Link *x);
-SI void link_after (Link *x, Link *y);
-SI void unlink (Link *x);
-SI void delete_link (Link *x);
+// Allocator handle for links (see linkpool.h). The `_in` functions take one; NULL means malloc() and free().
+// All links of a list, including the head, must come from the same place.
+typedef struct link_pool LinkPool;
+
+Link     *new_link (int val, Link *prev, Link *next);
+List      new_list ();
+List      make_list_from_array (int n, int array[n]);
+bool      insert_val_after (Link *after, int val);
+void      free_links (List head);
+void      print_list (List x);
+bool      contains (List x, int val);
+void      concatenate (List x, List y);
+void      delete_value (List x, int val);
+void      reverse (List x);
+List      copy_list (List x);
+bool      equal (List x, List y);
+bool      contains_prefetch (List x, int val);
+bool      contains_many (List x, int *vals, size_t k, bool *out);
+List      list_compact_in (LinkPool *pool, LinkPool **slab, List x);
+List      list_compact (LinkPool **slab, List x);
+int      *list_to_array (List x, size_t *n);
+List      list_from_array (LinkPool **pool, int n, int array[n]);
+Link     *new_link_in (LinkPool *pool, int val, Link *prev, Link *next);
+List      new_list_in (LinkPool *pool);
+List      make_list_from_array_in (LinkPool *pool, int n, int array[n]);
+bool      insert_val_after_in (LinkPool *pool, Link *after, int val);
+void      free_links_in (LinkPool *pool, List head);
+void      delete_value_in (LinkPool *pool, List x, int val);
+List      copy_list_in (LinkPool *pool, List x);
+void      free_link_in (LinkPool *pool, Link *x);
+SI void   connect (Link *x, Link *y);
+SI void   connect_neighbours (Link *x);
+SI void   link_after (Link *x, Link *y);
+SI void   unlink (Link *x);
+SI void   delete_link (Link *x);
 
 #define init_list_head(lnk)                                                                                            \
   (ListHead) { .prev = &(lnk), .next = &(lnk) }
 
+// For lists from malloc() only; free_list_in() or free_link_pool() for lists from a pool.
 #define free_list(lst)                                                                                                 \
   ({                                                                                                                   \
     free_links (lst);                                                                                                  \
+    assert (!(lst)->pooled);                                                                                           \
     free (lst);                                                                                                        \
     lst = NULL;                                                                                                        \
   })
 
+// free_list_in() gives the links back to the pool one by one, for reuse; free_link_pool() releases all lists in the
+// pool at once.
+#define free_list_in(pool, lst)                                                                                        \
+  ({                                                                                                                   \
+    free_links_in (pool, lst);                                                                                         \
+    free_link_in (pool, lst);                                                                                          \
+    lst = NULL;                                                                                                        \
+  })
+
 #define front(lst)                     (lst)->next
 #define last(lst)                      (lst)->prev
 #define is_empty(lst)                  ((lst) == front (lst))
-#define clear_head(head)               ({ (head) = init_list_head (head); })
+#define clear_head(head)               ({ (head).prev = (head).next = &(head); })
 #define clear_list(lst)                clear_head (*(lst))
 #define insert_val_before(before, val) insert_val_after ((before)->prev, val)
 #define prepend                        insert_val_after
 #define append                         insert_val_before
+#define prepend_in(pool, lst, val)     insert_val_after_in (pool, lst, val)
+#define append_in(pool, lst, val)      insert_val_after_in (pool, (lst)->prev, val)
 #define link_before(x, y)              link_after ((x)->prev, y)
 #define prepend_link                   link_after
 #define append_link                    link_before
@@ -103,9 +135,11 @@ unlink (Link *x)
   x->prev->next = x->next;
 }
 
+// For links from malloc() only; unlink() and free_link_in() for links from a pool.
 SI void
 delete_link (Link *x)
 {
+  assert (!x->pooled);
   unlink (x);
   free (x);
 }
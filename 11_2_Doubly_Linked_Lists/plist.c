@@ -0,0 +1,350 @@
+#include "plist.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+// -------------------- Thread Pool ----------------------------------------------------------------
+
+// Workers wait for a job; a job is a number of tasks that are handed out one by one.
+struct thread_pool
+{
+  int             n_threads;
+  pthread_t      *threads;
+  pthread_mutex_t mutex;
+  pthread_cond_t  work; // a new job or quit
+  pthread_cond_t  done; // all tasks of the job are done
+  void (*task) (int i, void *arg);
+  void *arg;
+  int   n_tasks;
+  int   next_task; // next task to hand out
+  int   finished;  // number of finished tasks
+  bool  quit;
+};
+
+static void *
+worker (void *p)
+{
+  ThreadPool *pool = p;
+  pthread_mutex_lock (&pool->mutex);
+  for (;;)
+    {
+      while (!pool->quit && pool->next_task == pool->n_tasks)
+        {
+          pthread_cond_wait (&pool->work, &pool->mutex);
+        }
+      if (pool->quit)
+        {
+          break;
+        }
+      int i = pool->next_task++;
+      pthread_mutex_unlock (&pool->mutex);
+
+      pool->task (i, pool->arg);
+
+      pthread_mutex_lock (&pool->mutex);
+      if (++pool->finished == pool->n_tasks)
+        {
+          pthread_cond_signal (&pool->done);
+        }
+    }
+  pthread_mutex_unlock (&pool->mutex);
+  return NULL;
+}
+
+ThreadPool *
+new_thread_pool (int n_threads)
+{
+  ThreadPool *pool = malloc (sizeof *pool);
+  if (!pool)
+    {
+      return NULL;
+    }
+  n_threads = n_threads > 0 ? n_threads : 1;
+  *pool     = (ThreadPool){ .threads = malloc (n_threads * sizeof *pool->threads) };
+  if (!pool->threads)
+    {
+      free (pool);
+      return NULL;
+    }
+  pthread_mutex_init (&pool->mutex, NULL);
+  pthread_cond_init (&pool->work, NULL);
+  pthread_cond_init (&pool->done, NULL);
+
+  for (; pool->n_threads < n_threads; pool->n_threads++)
+    {
+      if (pthread_create (&pool->threads[pool->n_threads], NULL, worker, pool))
+        {
+          free_thread_pool (pool);
+          return NULL;
+        }
+    }
+  return pool;
+}
+
+void
+free_thread_pool (ThreadPool *pool)
+{
+  pthread_mutex_lock (&pool->mutex);
+  pool->quit = true;
+  pthread_cond_broadcast (&pool->work);
+  pthread_mutex_unlock (&pool->mutex);
+  for (int i = 0; i < pool->n_threads; i++)
+    {
+      pthread_join (pool->threads[i], NULL);
+    }
+  pthread_mutex_destroy (&pool->mutex);
+  pthread_cond_destroy (&pool->work);
+  pthread_cond_destroy (&pool->done);
+  free (pool->threads);
+  free (pool);
+}
+
+// Runs task (i, arg) for i = 0 … n_tasks - 1 on the threads of the pool and waits until all are done.
+void
+pool_run (ThreadPool *pool, int n_tasks, void (*task) (int i, void *arg), void *arg)
+{
+  if (n_tasks == 0)
+    {
+      return;
+    }
+  pthread_mutex_lock (&pool->mutex);
+  pool->task      = task;
+  pool->arg       = arg;
+  pool->n_tasks   = n_tasks;
+  pool->next_task = 0;
+  pool->finished  = 0;
+  pthread_cond_broadcast (&pool->work);
+  while (pool->finished < n_tasks)
+    {
+      pthread_cond_wait (&pool->done, &pool->mutex);
+    }
+  pool->n_tasks = pool->next_task = 0;
+  pthread_mutex_unlock (&pool->mutex);
+}
+
+// -------------------- Segments -------------------------------------------------------------------
+
+// Checkpoints kept per segment, at least half of them after a thinning: the stride stays below a quarter segment.
+#define CHECKPOINTS_PER_SEGMENT 8
+
+// Cuts `x` into at most `k` segments whose lengths differ by at most one, in one pass. Segment i runs from starts[i] up
+// to, but not including, starts[i + 1]; the end of the last segment, starts[m], is the head. Returns the number of
+// segments m (0 for an empty list, fewer than k if the list is shorter than k), or -1 if there is no memory.
+int
+cut_list (List x, int k, Link *starts[k + 1])
+{
+  int    cap         = CHECKPOINTS_PER_SEGMENT * k;
+  Link **checkpoints = malloc (cap * sizeof *checkpoints);
+  if (!checkpoints)
+    {
+      return -1;
+    }
+  int    n      = 0; // number of checkpoints; checkpoints[c] is link number c * stride
+  size_t stride = 1;
+  size_t len    = 0; // links seen so far
+  for (Link *link = front (x); link != x; link = link->next, len++)
+    {
+      if (len % stride)
+        {
+          continue;
+        }
+      if (n == cap) // too many; keep every other one
+        {
+          for (int j = 0; j < cap / 2; j++)
+            {
+              checkpoints[j] = checkpoints[2 * j];
+            }
+          n = cap / 2;
+          stride *= 2;
+          if (len % stride)
+            {
+              continue;
+            }
+        }
+      checkpoints[n++] = link;
+    }
+
+  int m = len < (size_t)k ? (int)len : k;
+  for (int j = 0; j < m; j++)
+    {
+      size_t at   = (size_t)j * len / m; // link number of the start
+      Link  *link = checkpoints[at / stride];
+      for (size_t d = at % stride; d; d--)
+        {
+          link = link->next;
+        }
+      starts[j] = link;
+    }
+  starts[m] = x;
+  free (checkpoints);
+  return m;
+}
+
+// -------------------- Map, Filter, Reduce --------------------------------------------------------
+
+typedef struct par_job
+{
+  Link     **starts;
+  void      *arg;
+  map_fn     map;
+  keep_fn    keep;
+  reduce_fn  reduce;
+  combine_fn combine;
+  long       init;
+  long      *partial; // reduce: result per segment
+  Link     **first;   // filter: kept chain per segment …
+  Link     **last;    // … and its end
+  Link     **dropped; // filter: rejected links per segment, chained through `next`
+} ParJob;
+
+static void
+map_segment (int i, void *p)
+{
+  ParJob *job = p;
+  for (Link *link = job->starts[i]; link != job->starts[i + 1]; link = link->next)
+    {
+      link->value = job->map (link->value, job->arg);
+    }
+}
+
+static void
+reduce_segment (int i, void *p)
+{
+  ParJob *job = p;
+  long    acc = job->init;
+  for (Link *link = job->starts[i]; link != job->starts[i + 1]; link = link->next)
+    {
+      acc = job->combine (acc, job->reduce (link->value, job->arg));
+    }
+  job->partial[i] = acc;
+}
+
+// Kept links are connected into a chain, the others into a second one, to be freed by the caller: a LinkPool is
+// not thread safe. Only links of the segment are written to. (`link` is a macro for connect in list.h, hence `lnk`.)
+static void
+filter_segment (int i, void *p)
+{
+  ParJob *job     = p;
+  Link   *first   = NULL;
+  Link   *last    = NULL;
+  Link   *dropped = NULL;
+  Link   *lnk     = job->starts[i];
+  while (lnk != job->starts[i + 1])
+    {
+      Link *next = lnk->next;
+      if (job->keep (lnk->value, job->arg))
+        {
+          if (last)
+            {
+              connect (last, lnk);
+            }
+          else
+            {
+              first = lnk;
+            }
+          last = lnk;
+        }
+      else
+        {
+          lnk->next = dropped;
+          dropped   = lnk;
+        }
+      lnk = next;
+    }
+  job->first[i]   = first;
+  job->last[i]    = last;
+  job->dropped[i] = dropped;
+}
+
+// A few segments per thread, so a slow segment doesn't hold up the others.
+#define SEGMENTS_PER_THREAD 4
+
+// Cut `x` into segments and run `task` on them. The segment starts and `per_segment` bytes of results per segment
+// (job->partial, or job->first, job->last and job->dropped) are one allocation; the caller frees job->starts.
+static int
+run_segments (ThreadPool *pool, List x, ParJob *job, void (*task) (int i, void *arg), size_t per_segment)
+{
+  int k       = SEGMENTS_PER_THREAD * pool->n_threads;
+  job->starts = malloc ((k + 1) * sizeof *job->starts + k * per_segment);
+  if (!job->starts)
+    {
+      return -1;
+    }
+  int m = cut_list (x, k, job->starts);
+  if (m < 0)
+    {
+      free (job->starts);
+      return -1;
+    }
+  job->partial = (long *)(job->starts + k + 1);
+  job->first   = job->starts + k + 1;
+  job->last    = job->first + k;
+  job->dropped = job->last + k;
+  pool_run (pool, m, task, job);
+  return m;
+}
+
+bool
+list_map_par (ThreadPool *pool, List x, map_fn f, void *arg)
+{
+  ParJob job = { .map = f, .arg = arg };
+  if (run_segments (pool, x, &job, map_segment, 0) < 0)
+    {
+      return false;
+    }
+  free (job.starts);
+  return true;
+}
+
+// `combine` must be associative and `init` its neutral element; the segments are combined in list order.
+bool
+list_reduce_par (ThreadPool *pool, List x, reduce_fn f, combine_fn combine, long init, void *arg, long *result)
+{
+  ParJob job = { .reduce = f, .combine = combine, .init = init, .arg = arg };
+  int    m   = run_segments (pool, x, &job, reduce_segment, sizeof (long));
+  if (m < 0)
+    {
+      return false;
+    }
+  *result = init;
+  for (int i = 0; i < m; i++)
+    {
+      *result = combine (*result, job.partial[i]);
+    }
+  free (job.starts);
+  return true;
+}
+
+// Removes the links whose values `keep` rejects, and gives them back to `links` (NULL: free()).
+bool
+list_filter_par_in (LinkPool *links, ThreadPool *pool, List x, keep_fn keep, void *arg)
+{
+  ParJob job = { .keep = keep, .arg = arg };
+  int    m   = run_segments (pool, x, &job, filter_segment, 3 * sizeof (Link *));
+  if (m < 0)
+    {
+      return false;
+    }
+  Link *prev = x;
+  for (int i = 0; i < m; i++)
+    {
+      if (job.first[i])
+        {
+          connect (prev, job.first[i]);
+          prev = job.last[i];
+        }
+      for (Link *lnk = job.dropped[i], *next; lnk; lnk = next)
+        {
+          next = lnk->next;
+          free_link_in (links, lnk);
+        }
+    }
+  connect (prev, x);
+  free (job.starts);
+  return true;
+}
+
+bool
+list_filter_par (ThreadPool *pool, List x, keep_fn keep, void *arg)
+{
+  return list_filter_par_in (NULL, pool, x, keep, arg);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "list.h"
+#include <stdbool.h>
+
+// Parallel map, filter and reduce over the lists in list.h.
+//
+// A list is cut into segments in one pass: while walking it, we keep every stride-th link as a checkpoint, and
+// double the stride (dropping every other checkpoint) whenever we have too many. At the end the length is known, and
+// each segment starts at its share of the links, found by walking on from the checkpoint before it (less than a
+// quarter of a segment). The segments are then handed to the threads of a pool; each thread only touches the links
+// of its own segments. Filtering relinks the kept links of each segment into a chain, and the chains are joined
+// again afterwards, in order, in O(number of segments); the rejected links are freed afterwards as well.
+//
+// The callbacks are called from several threads at once and must not touch the list. The functions return false
+// if there is no memory for the bookkeeping (the list is unchanged then).
+
+typedef struct thread_pool ThreadPool;
+
+typedef int  (*map_fn) (int val, void *arg);
+typedef bool (*keep_fn) (int val, void *arg);
+typedef long (*reduce_fn) (int val, void *arg);
+typedef long (*combine_fn) (long x, long y);
+
+ThreadPool *new_thread_pool (int n_threads);
+void        free_thread_pool (ThreadPool *pool);
+void        pool_run (ThreadPool *pool, int n_tasks, void (*task) (int i, void *arg), void *arg);
+int         cut_list (List x, int k, Link *starts[k + 1]);
+bool        list_map_par (ThreadPool *pool, List x, map_fn f, void *arg);
+bool        list_filter_par (ThreadPool *pool, List x, keep_fn keep, void *arg);
+bool        list_filter_par_in (LinkPool *links, ThreadPool *pool, List x, keep_fn keep, void *arg);
+bool list_reduce_par (ThreadPool *pool, List x, reduce_fn f, combine_fn combine, long init, void *arg, long *result);
@@ -0,0 +1,362 @@
+#include "skiplist.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// -------------------- Locking --------------------------------------------------------------------
+
+void
+sl_read_lock (SkipList *sl)
+{
+  if (sl->concurrent)
+    {
+      pthread_rwlock_rdlock (&sl->lock);
+    }
+}
+
+static void
+write_lock (SkipList *sl)
+{
+  if (sl->concurrent)
+    {
+      pthread_rwlock_wrlock (&sl->lock);
+    }
+}
+
+// Releases a read or write lock.
+void
+sl_unlock (SkipList *sl)
+{
+  if (sl->concurrent)
+    {
+      pthread_rwlock_unlock (&sl->lock);
+    }
+}
+
+// -------------------- Nodes ----------------------------------------------------------------------
+
+static SLNode *
+new_node (int val, int height)
+{
+  SLNode *node = malloc (offsetof (SLNode, levels) + height * sizeof *node->levels);
+  if (!node)
+    {
+      return NULL;
+    }
+  node->value  = val;
+  node->height = height;
+  return node;
+}
+
+// Height 1 with probability 1/2, height 2 with probability 1/4, … (xorshift random numbers; the number of trailing
+// zero bits is geometrically distributed).
+static int
+random_height (SkipList *sl)
+{
+  unsigned x = sl->seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  sl->seed = x;
+  return 1 + __builtin_ctz (x | 1u << (SL_MAX_LEVEL - 1));
+}
+
+// -------------------- Skip List ------------------------------------------------------------------
+
+// create new empty skip list (consists only of head)
+SkipList *
+sl_new_list (bool concurrent)
+{
+  SkipList *sl = malloc (sizeof *sl);
+  if (!sl)
+    {
+      return NULL;
+    }
+  sl->head = new_node (314159, SL_MAX_LEVEL);
+  if (!sl->head)
+    {
+      free (sl);
+      return NULL;
+    }
+  if (concurrent && pthread_rwlock_init (&sl->lock, NULL))
+    {
+      free (sl->head);
+      free (sl);
+      return NULL;
+    }
+
+  for (int i = 0; i < SL_MAX_LEVEL; i++)
+    {
+      sl->head->levels[i] = (SLLevel){ .prev = sl->head, .next = sl->head, .span = 1 };
+    }
+  sl->level      = 1;
+  sl->length     = 0;
+  sl->seed       = 2463534242;
+  sl->concurrent = concurrent;
+  return sl;
+}
+
+void
+sl_free_list (SkipList *sl)
+{
+  SLNode *node = sl_front (sl);
+  while (node != sl->head)
+    {
+      SLNode *next = sl_next (node);
+      free (node);
+      node = next;
+    }
+  free (sl->head);
+  if (sl->concurrent)
+    {
+      pthread_rwlock_destroy (&sl->lock);
+    }
+  free (sl);
+}
+
+// For every level in use, find the last node with a value less than `val` (`update`) and its rank.
+static void
+find_predecessors (SkipList *sl, int val, SLNode *update[], size_t rank[])
+{
+  SLNode *x = sl->head;
+  size_t  r = 0;
+  for (int i = sl->level - 1; i >= 0; i--)
+    {
+      SLNode *next;
+      while ((next = x->levels[i].next) != sl->head && next->value < val)
+        {
+          r += x->levels[i].span;
+          x = next;
+        }
+      update[i] = x;
+      rank[i]   = r;
+    }
+}
+
+static bool
+insert_unlocked (SkipList *sl, int val)
+{
+  SLNode *update[SL_MAX_LEVEL];
+  size_t  rank[SL_MAX_LEVEL];
+  find_predecessors (sl, val, update, rank);
+
+  SLNode *next = update[0]->levels[0].next;
+  if (next != sl->head && next->value == val)
+    {
+      return true; // already there
+    }
+
+  int     h = random_height (sl);
+  SLNode *x = new_node (val, h);
+  if (!x)
+    {
+      return false;
+    }
+
+  // new levels are empty: the head links to itself, skipping all nodes
+  for (int i = sl->level; i < h; i++)
+    {
+      update[i]                = sl->head;
+      rank[i]                  = 0;
+      sl->head->levels[i].span = sl->length + 1;
+    }
+  if (h > sl->level)
+    {
+      sl->level = h;
+    }
+
+  // `x` goes right after update[0], at rank[0] + 1
+  for (int i = 0; i < h; i++)
+    {
+      size_t skipped = rank[0] - rank[i]; // level 0 steps from update[i] to update[0]
+      sl_link_after (update[i], x, i);
+      x->levels[i].span         = update[i]->levels[i].span - skipped;
+      update[i]->levels[i].span = skipped + 1;
+    }
+  // links above `x` skip one more node
+  for (int i = h; i < sl->level; i++)
+    {
+      update[i]->levels[i].span++;
+    }
+
+  sl->length++;
+  return true;
+}
+
+static bool
+delete_unlocked (SkipList *sl, int val)
+{
+  SLNode *update[SL_MAX_LEVEL];
+  size_t  rank[SL_MAX_LEVEL];
+  find_predecessors (sl, val, update, rank);
+
+  SLNode *x = update[0]->levels[0].next;
+  if (x == sl->head || x->value != val)
+    {
+      return false;
+    }
+
+  for (int i = 0; i < sl->level; i++)
+    {
+      if (i < x->height)
+        {
+          update[i]->levels[i].span += x->levels[i].span - 1;
+          sl_unlink (x, i);
+        }
+      else
+        {
+          update[i]->levels[i].span--;
+        }
+    }
+  free (x);
+
+  while (sl->level > 1 && sl->head->levels[sl->level - 1].next == sl->head)
+    {
+      sl->level--;
+    }
+  sl->length--;
+  return true;
+}
+
+// Returns false only if there is no memory for a new node. Inserting a value that is already in the list changes
+// nothing.
+bool
+sl_insert (SkipList *sl, int val)
+{
+  write_lock (sl);
+  bool ok = insert_unlocked (sl, val);
+  sl_unlock (sl);
+  return ok;
+}
+
+// Returns true if `val` was in the list.
+bool
+sl_delete (SkipList *sl, int val)
+{
+  write_lock (sl);
+  bool found = delete_unlocked (sl, val);
+  sl_unlock (sl);
+  return found;
+}
+
+SkipList *
+sl_make_list_from_array (int n, int array[n])
+{
+  SkipList *sl = sl_new_list (false);
+  if (!sl)
+    {
+      return NULL;
+    }
+  for (int i = 0; i < n; i++)
+    {
+      if (!insert_unlocked (sl, array[i]))
+        {
+          sl_free_list (sl);
+          return NULL;
+        }
+    }
+  return sl;
+}
+
+// Returns the node with `val` or NULL; sets `rank` to the rank of `val` or of its predecessor.
+static SLNode *
+find_node (SkipList *sl, int val, size_t *rank)
+{
+  SLNode *x = sl->head;
+  size_t  r = 0;
+  for (int i = sl->level - 1; i >= 0; i--)
+    {
+      SLNode *next;
+      while ((next = x->levels[i].next) != sl->head && next->value <= val)
+        {
+          r += x->levels[i].span;
+          x = next;
+        }
+      if (x != sl->head && x->value == val)
+        {
+          break; // no need to go further down
+        }
+    }
+  *rank = r;
+  return (x != sl->head && x->value == val) ? x : NULL;
+}
+
+bool
+sl_contains (SkipList *sl, int val)
+{
+  size_t rank;
+  sl_read_lock (sl);
+  bool found = find_node (sl, val, &rank);
+  sl_unlock (sl);
+  return found;
+}
+
+// Position of `val` in the list (1 for the smallest value), or 0 if it's not there.
+size_t
+sl_rank (SkipList *sl, int val)
+{
+  size_t rank;
+  sl_read_lock (sl);
+  SLNode *x = find_node (sl, val, &rank);
+  sl_unlock (sl);
+  return x ? rank : 0;
+}
+
+// Stores the value at position `rank` (1 for the smallest value) in *val. Returns false if there is no such position.
+// The value is copied under the lock: in concurrent mode its node may be deleted as soon as the lock is released.
+bool
+sl_at (SkipList *sl, size_t rank, int *val)
+{
+  sl_read_lock (sl);
+  bool found = rank > 0 && rank <= sl->length;
+  if (found)
+    {
+      size_t  r = 0;
+      SLNode *x = sl->head;
+      for (int i = sl->level - 1; i >= 0 && r < rank; i--)
+        {
+          while (x->levels[i].next != sl->head && r + x->levels[i].span <= rank)
+            {
+              r += x->levels[i].span;
+              x = x->levels[i].next;
+            }
+        }
+      *val = x->value;
+    }
+  sl_unlock (sl);
+  return found;
+}
+
+size_t
+sl_length (SkipList *sl)
+{
+  sl_read_lock (sl);
+  size_t length = sl->length;
+  sl_unlock (sl);
+  return length;
+}
+
+void
+sl_print_list (SkipList *sl)
+{
+  printf ("[ ");
+  sl_for_each (node, sl)
+  {
+    printf ("%d ", node->value);
+  }
+  printf ("]\n");
+}
+
+// Shows the towers: one line per level, top level first, with the span of each link.
+void
+sl_print_levels (SkipList *sl)
+{
+  for (int i = sl->level - 1; i >= 0; i--)
+    {
+      printf ("%2d: head(%zu)", i, sl->head->levels[i].span);
+      for (SLNode *node = sl->head->levels[i].next; node != sl->head; node = node->levels[i].next)
+        {
+          printf (" → %d(%zu)", node->value, node->levels[i].span);
+        }
+      printf ("\n");
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#define SI static inline /* for link operations */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Skip list of unique ints in ascending order.
+// Every level is a circular doubly linked list as in list.h, with the same kind of dummy link, the head, at the
+// beginning. Level 0 holds all nodes; each level above holds about half of the nodes of the level below, so a search
+// can skip over most of the nodes. The links of a node (its tower) are stored inline in the node, in a flexible
+// array member; a node of height h has the links for levels 0 .. h - 1.
+//
+// Level 2: head ----------------------------→ 5 -------------------→ (head)
+// Level 1: head -------→ 2 -----------------→ 5 -------→ 7 --------→ (head)
+// Level 0: head → 1 → 2 → 3 → 4 → 5 → 6 → 7 → 8 → (head)
+//
+// Each link also knows its `span`, the number of level 0 steps it skips. Adding up the spans along the search path
+// gives the rank (position) of a node. The head is at position 0 and at position length + 1 (that's where the last
+// link of each level points to), so the spans of a level always add up to length + 1.
+//
+// Expected O(log n) for insert, delete, lookup, rank and selecting the k-th value.
+//
+// Concurrent mode: a skip list created with `concurrent` set protects itself with a readers–writer lock. Lookups
+// (sl_contains, sl_rank, sl_at) run in parallel, inserts and deletes exclusively. Iterating (sl_for_each) is not
+// covered; wrap it in sl_read_lock() and sl_unlock().
+
+#define SL_MAX_LEVEL 32
+
+struct sl_node;
+
+typedef struct sl_level
+{
+  struct sl_node *prev;
+  struct sl_node *next;
+  size_t          span; // number of level 0 steps to `next`
+} SLLevel;
+
+typedef struct sl_node
+{
+  int     value;
+  int     height;   // number of levels the node is linked into
+  SLLevel levels[]; // tower; flexible array member must be at end of struct
+} SLNode;
+
+typedef struct skip_list
+{
+  SLNode          *head;   // dummy node with SL_MAX_LEVEL levels
+  int              level;  // number of levels in use (at least 1)
+  size_t           length; // number of nodes without head
+  unsigned         seed;   // random number state for node heights
+  bool             concurrent;
+  pthread_rwlock_t lock;
+} SkipList;
+
+SkipList *sl_new_list (bool concurrent);
+SkipList *sl_make_list_from_array (int n, int array[n]);
+void      sl_free_list (SkipList *sl);
+bool      sl_insert (SkipList *sl, int val);
+bool      sl_delete (SkipList *sl, int val);
+bool      sl_contains (SkipList *sl, int val);
+size_t    sl_rank (SkipList *sl, int val);
+bool      sl_at (SkipList *sl, size_t rank, int *val);
+size_t    sl_length (SkipList *sl);
+void      sl_print_list (SkipList *sl);
+void      sl_print_levels (SkipList *sl);
+void      sl_read_lock (SkipList *sl);
+void      sl_unlock (SkipList *sl);
+SI void   sl_connect (SLNode *x, SLNode *y, int i);
+SI void   sl_connect_neighbours (SLNode *x, int i);
+SI void   sl_link_after (SLNode *x, SLNode *y, int i);
+SI void   sl_unlink (SLNode *x, int i);
+
+#define sl_front(sl)       (sl)->head->levels[0].next
+#define sl_last(sl)        (sl)->head->levels[0].prev
+#define sl_is_empty(sl)    (sl_front (sl) == (sl)->head)
+#define sl_next(node)      (node)->levels[0].next
+#define sl_prev(node)      (node)->levels[0].prev
+#define sl_for_each(n, sl) for (SLNode *n = sl_front (sl); n != (sl)->head; n = sl_next (n))
+
+// -------------------- Link operations ------------------------------------------------------------
+// Same as in list.h, on level `i` of the towers.
+
+// connect nodes x and y on level i
+SI void
+sl_connect (SLNode *x, SLNode *y, int i)
+{
+  x->levels[i].next = y;
+  y->levels[i].prev = x;
+}
+
+// Make x consistent with its neighbors on level i.
+SI void
+sl_connect_neighbours (SLNode *x, int i)
+{
+  x->levels[i].next->levels[i].prev = x;
+  x->levels[i].prev->levels[i].next = x;
+}
+
+// Place node `y` after node `x` on level i.
+SI void
+sl_link_after (SLNode *x, SLNode *y, int i)
+{
+  y->levels[i].prev = x;
+  y->levels[i].next = x->levels[i].next;
+  sl_connect_neighbours (y, i);
+}
+
+// Removes node `x` from level i, but leave its pointers.
+SI void
+sl_unlink (SLNode *x, int i)
+{
+  sl_connect (x->levels[i].prev, x->levels[i].next, i);
+}
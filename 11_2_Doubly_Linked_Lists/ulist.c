@@ -0,0 +1,346 @@
+#include "ulist.h"
+#include <stdio.h>
+#include <string.h>
+
+ULink *
+ul_new_link (ULink *prev, ULink *next)
+{
+  ULink *pLink = malloc (sizeof *pLink);
+  if (!pLink)
+    {
+      return NULL;
+    }
+  pLink->prev  = prev;
+  pLink->next  = next;
+  pLink->count = 0;
+  return pLink;
+}
+
+// create new empty list (consists only of dummy)
+UList
+ul_new_list ()
+{
+  ULink *head = ul_new_link (NULL, NULL);
+  if (!head)
+    {
+      return NULL;
+    }
+  *head = ul_init_list_head (*head);
+  return head;
+}
+
+// Free real links, but not head/dummy; result is an empty list.
+void
+ul_free_links (UList head)
+{
+  ULink *link = ul_front (head);
+  while (link != head)
+    {
+      ULink *next = link->next;
+      free (link);
+      link = next;
+    }
+  ul_clear_list (head);
+}
+
+// Add a new, empty link after `after`.
+static ULink *
+insert_link_after (ULink *after)
+{
+  ULink *link = ul_new_link (after, after->next);
+  if (link)
+    {
+      ul_connect_neighbours (link);
+    }
+  return link;
+}
+
+bool
+ul_append (UList x, int val)
+{
+  ULink *link = ul_last (x);
+  if (link == x || ul_is_full (link))
+    {
+      link = insert_link_after (ul_last (x));
+      if (!link)
+        {
+          return false;
+        }
+    }
+  link->values[link->count++] = val;
+  return true;
+}
+
+bool
+ul_prepend (UList x, int val)
+{
+  ULink *link = ul_front (x);
+  if (link == x || ul_is_full (link))
+    {
+      link = insert_link_after (x);
+      if (!link)
+        {
+          return false;
+        }
+    }
+  memmove (link->values + 1, link->values, link->count * sizeof *link->values);
+  link->values[0] = val;
+  link->count++;
+  return true;
+}
+
+// Insert `val` so that it ends up at index `pos` (0 <= pos <= length).
+// A full link is split in two halves first.
+bool
+ul_insert_at (UList x, size_t pos, int val)
+{
+  ULink *link = ul_front (x);
+  while (link != x && pos > (size_t)link->count)
+    {
+      pos -= link->count;
+      link = link->next;
+    }
+  if (link == x)
+    {
+      assert (pos == 0);
+      return ul_append (x, val);
+    }
+
+  if (ul_is_full (link))
+    {
+      ULink *upper = insert_link_after (link);
+      if (!upper)
+        {
+          return false;
+        }
+      size_t half  = UL_K / 2;
+      upper->count = UL_K - half;
+      memcpy (upper->values, link->values + half, upper->count * sizeof *link->values);
+      link->count = half;
+      if (pos > half)
+        {
+          pos -= half;
+          link = upper;
+        }
+    }
+
+  memmove (link->values + pos + 1, link->values + pos, (link->count - pos) * sizeof *link->values);
+  link->values[pos] = val;
+  link->count++;
+  return true;
+}
+
+UList
+ul_make_list_from_array (int n, int array[n])
+{
+  UList x = ul_new_list ();
+  if (!x)
+    {
+      return NULL;
+    }
+
+  for (int i = 0; i < n; i += UL_K)
+    {
+      ULink *link = insert_link_after (ul_last (x));
+      if (!link)
+        {
+          ul_free_list (x);
+          return NULL;
+        }
+      link->count = (n - i < UL_K) ? n - i : UL_K;
+      memcpy (link->values, array + i, link->count * sizeof *array);
+    }
+  return x;
+}
+
+void
+ul_print_list (UList x)
+{
+  printf ("[ ");
+  for (ULink *link = ul_front (x); link != x; link = link->next)
+    {
+      for (int i = 0; i < link->count; i++)
+        {
+          printf ("%d ", link->values[i]);
+        }
+    }
+  printf ("]\n");
+}
+
+// Like ul_print_list() but shows the links.
+void
+ul_print_links (UList x)
+{
+  printf ("[ ");
+  for (ULink *link = ul_front (x); link != x; link = link->next)
+    {
+      printf ("(");
+      for (int i = 0; i < link->count; i++)
+        {
+          printf (i ? " %d" : "%d", link->values[i]);
+        }
+      printf (") ");
+    }
+  printf ("]\n");
+}
+
+size_t
+ul_length (UList x)
+{
+  size_t n = 0;
+  for (ULink *link = ul_front (x); link != x; link = link->next)
+    {
+      n += link->count;
+    }
+  return n;
+}
+
+bool
+ul_contains (UList x, int val)
+{
+  for (ULink *link = ul_front (x); link != x; link = link->next)
+    {
+      for (int i = 0; i < link->count; i++)
+        {
+          if (link->values[i] == val)
+            {
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+// We don't delete y, but we empty it. The links are moved as they are, without merging.
+void
+ul_concatenate (UList x, UList y)
+{
+  if (ul_is_empty (y))
+    {
+      return;
+    }
+  ul_connect (ul_last (x), ul_front (y));
+  ul_connect (ul_last (y), x);
+  ul_clear_list (y);
+}
+
+// Remove all occurrences of `val`.
+// Each link is compacted in place; empty links are deleted, and a link is merged into its predecessor
+// when both fit into one link, so a list doesn't end up as a chain of nearly empty links.
+void
+ul_delete_value (UList x, int val)
+{
+  ULink *link = ul_front (x);
+  while (link != x)
+    {
+      ULink *next  = link->next;
+      int    count = 0;
+      for (int i = 0; i < link->count; i++)
+        {
+          if (link->values[i] != val)
+            {
+              link->values[count++] = link->values[i];
+            }
+        }
+      link->count = count;
+
+      ULink *prev = link->prev;
+      if (link->count == 0)
+        {
+          ul_delete_link (link);
+        }
+      else if (prev != x && prev->count + link->count <= UL_K)
+        {
+          memcpy (prev->values + prev->count, link->values, link->count * sizeof *link->values);
+          prev->count += link->count;
+          ul_delete_link (link);
+        }
+      link = next;
+    }
+}
+
+// swap x and y
+#define swap_pointers(x, y)                                                                                            \
+  do                                                                                                                   \
+    {                                                                                                                  \
+      ULink *tmp = x;                                                                                                  \
+      x          = y;                                                                                                  \
+      y          = tmp;                                                                                                \
+    }                                                                                                                  \
+  while (0)
+
+// Reverse the order of the links (as in list.c) and the values inside each link.
+void
+ul_reverse (UList x)
+{
+  ULink *p = x;
+  do
+    {
+      for (int i = 0, j = p->count - 1; i < j; i++, j--)
+        {
+          int tmp      = p->values[i];
+          p->values[i] = p->values[j];
+          p->values[j] = tmp;
+        }
+      swap_pointers (p->prev, p->next);
+      p = p->prev; // prev is the old next
+    }
+  while (p != x);
+}
+
+UList
+ul_copy_list (UList x)
+{
+  UList newlist = ul_new_list ();
+  if (!newlist)
+    {
+      return NULL;
+    }
+
+  for (ULink *p = ul_front (x); p != x; p = p->next)
+    {
+      ULink *link = insert_link_after (ul_last (newlist));
+      if (!link)
+        {
+          ul_free_list (newlist);
+          return NULL;
+        }
+      link->count = p->count;
+      memcpy (link->values, p->values, p->count * sizeof *p->values);
+    }
+
+  return newlist;
+}
+
+// The lists may hold the same values in differently filled links.
+bool
+ul_equal (UList x, UList y)
+{
+  ULink *p = ul_front (x);
+  ULink *q = ul_front (y);
+  int    i = 0;
+  int    j = 0;
+
+  for (;;)
+    {
+      // links are never empty, so one step is enough to get past the end of a link
+      if (p != x && i == p->count)
+        {
+          p = p->next;
+          i = 0;
+        }
+      if (q != y && j == q->count)
+        {
+          q = q->next;
+          j = 0;
+        }
+      if (p == x || q == y)
+        {
+          return (p == x) && (q == y);
+        }
+      if (p->values[i++] != q->values[j++])
+        {
+          return false;
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#define SI static inline /* for link operations */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Unrolled version of the circular doubly linked list in list.h.
+// A link holds up to UL_K values in a small array instead of a single value. With two pointers, a count and
+// UL_K = 11 ints a link is 64 bytes, i.e., one cache line on most machines, and most of it is payload.
+// Traversals follow a pointer once per UL_K values instead of once per value.
+//
+// The structure is the same as in list.h: a dummy link (the head, holding no values) at the beginning, the last
+// link's next points to the head, the head's prev points to the last link. An empty list is just the head.
+//
+// Values keep their list order within a link (values[0] .. values[count - 1]) and across links.
+// Links of a non-empty list are never empty. Inserting into a full link splits it in two; deleting values merges
+// a link into its predecessor when the values of both fit into one link.
+
+#define UL_K 11
+
+typedef struct ulink
+{
+  struct ulink *prev;
+  struct ulink *next;
+  int           count;
+  int           values[UL_K];
+} ULink;
+
+typedef ULink      UListHead; // UListHead is a link, the dummy link.
+typedef UListHead *UList;     // UList is a pointer to the head/dummy link.
+
+ULink  *ul_new_link (ULink *prev, ULink *next);
+UList   ul_new_list ();
+UList   ul_make_list_from_array (int n, int array[n]);
+bool    ul_append (UList x, int val);
+bool    ul_prepend (UList x, int val);
+bool    ul_insert_at (UList x, size_t pos, int val);
+void    ul_free_links (UList head);
+void    ul_print_list (UList x);
+void    ul_print_links (UList x);
+size_t  ul_length (UList x);
+bool    ul_contains (UList x, int val);
+void    ul_concatenate (UList x, UList y);
+void    ul_delete_value (UList x, int val);
+void    ul_reverse (UList x);
+UList   ul_copy_list (UList x);
+bool    ul_equal (UList x, UList y);
+SI void ul_connect (ULink *x, ULink *y);
+SI void ul_connect_neighbours (ULink *x);
+SI void ul_link_after (ULink *x, ULink *y);
+SI void ul_unlink (ULink *x);
+SI void ul_delete_link (ULink *x);
+
+#define ul_init_list_head(lnk)                                                                                         \
+  (UListHead) { .prev = &(lnk), .next = &(lnk), .count = 0 }
+
+#define ul_free_list(lst)                                                                                              \
+  ({                                                                                                                   \
+    ul_free_links (lst);                                                                                               \
+    free (lst);                                                                                                        \
+    lst = NULL;                                                                                                        \
+  })
+
+#define ul_front(lst)       (lst)->next
+#define ul_last(lst)        (lst)->prev
+#define ul_is_empty(lst)    ((lst) == ul_front (lst))
+#define ul_clear_head(head) ({ (head) = ul_init_list_head (head); })
+#define ul_clear_list(lst)  ul_clear_head (*(lst))
+#define ul_is_full(lnk)     ((lnk)->count == UL_K)
+
+// -------------------- Link operations ------------------------------------------------------------
+
+// connect links x and y
+SI void
+ul_connect (ULink *x, ULink *y)
+{
+  x->next = y;
+  y->prev = x;
+}
+
+// Removes link `x` from list, but leave its pointers.
+SI void
+ul_unlink (ULink *x)
+{
+  x->next->prev = x->prev;
+  x->prev->next = x->next;
+}
+
+SI void
+ul_delete_link (ULink *x)
+{
+  ul_unlink (x);
+  free (x);
+}
+
+// Make x consistent with its neighbors.
+SI void
+ul_connect_neighbours (ULink *x)
+{
+  x->next->prev = x;
+  x->prev->next = x;
+}
+
+// Place link `y` after link `x`.
+SI void
+ul_link_after (ULink *x, ULink *y)
+{
+  y->prev = x;
+  y->next = x->next;
+  ul_connect_neighbours (y);
+}
@@ -0,0 +1,527 @@
+// The search tree of 12_4_iterative.c with two other ways to get its nodes:
+//
+//   - From an arena: new_node() cuts nodes out of large chunks, and free_node() puts them on a free list for the next
+//     new_node(). Freeing the whole tree doesn't walk it: free_arena() frees the chunks, O(n / CHUNK_NODES) calls to
+//     free() instead of one per node (cp. free_nodes() in 12_5_explicit-stack.c and 12_6_explicit-stack-embed.c).
+//     Each tree needs its own arena then. Without an arena (NULL), the nodes come from malloc() as before.
+//   - From an array, with 32-bit indices instead of pointers (stree32). A node shrinks from 24 to 12 bytes, so twice as
+//     many fit into the cache. Indices stay valid when the array grows with realloc(), and freeing the tree is one
+//     free(). Index 0 is the empty tree; a tree holds fewer than 2^32 nodes.
+//
+// See benchmark() for the difference at 10^7 nodes.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define CHUNK_NODES 4096
+
+// -------------------- Tree -----------------------------------------------------------------------
+
+typedef struct node
+{
+  int          value;
+  struct node *left;
+  struct node *right;
+} Node;
+
+typedef Node *stree;
+
+#define EMPTY_TREE NULL
+
+// -------------------- Arena ----------------------------------------------------------------------
+
+typedef struct chunk
+{
+  struct chunk *next;
+  Node          nodes[CHUNK_NODES];
+} Chunk;
+
+typedef struct arena
+{
+  Chunk *chunks;    // the newest chunk first
+  int    used;      // nodes handed out from the newest chunk
+  Node  *free_list; // freed nodes, linked through `left`
+} Arena;
+
+// With `a` NULL, the node comes from malloc().
+Node *
+new_node (Arena *a, int value)
+{
+  Node *n;
+  if (!a)
+    {
+      n = malloc (sizeof *n);
+    }
+  else if (a->free_list)
+    {
+      n            = a->free_list;
+      a->free_list = n->left;
+    }
+  else
+    {
+      if (!a->chunks || a->used == CHUNK_NODES)
+        {
+          Chunk *c = malloc (sizeof *c);
+          if (!c)
+            {
+              return NULL;
+            }
+          c->next   = a->chunks;
+          a->chunks = c;
+          a->used   = 0;
+        }
+      n = &a->chunks->nodes[a->used++];
+    }
+  if (n)
+    {
+      *n = (Node){ .value = value };
+    }
+  return n;
+}
+
+void
+free_node (Arena *a, Node *n)
+{
+  if (!a)
+    {
+      free (n);
+      return;
+    }
+  n->left      = a->free_list;
+  a->free_list = n;
+}
+
+// Frees every node from the arena at once, without looking at them.
+void
+free_arena (Arena *a)
+{
+  while (a->chunks)
+    {
+      Chunk *next = a->chunks->next;
+      free (a->chunks);
+      a->chunks = next;
+    }
+  *a = (Arena){ 0 };
+}
+
+// -------------------- Search Tree ----------------------------------------------------------------
+
+stree *
+find_loc (stree *t, int val)
+{
+  while (*t && val != (*t)->value)
+    {
+      t = val < (*t)->value ? &(*t)->left : &(*t)->right;
+    }
+  return t;
+}
+
+bool
+contains (stree *t, int val)
+{
+  return !!*find_loc (t, val);
+}
+
+bool
+insert (Arena *a, stree *t, int val)
+{
+  stree *loc = find_loc (t, val);
+  if (!*loc)
+    {
+      *loc = new_node (a, val);
+    }
+  return !!*loc;
+}
+
+stree *
+rightmost (stree *t)
+{
+  while ((*t)->right)
+    {
+      t = &(*t)->right;
+    }
+  return t;
+}
+
+void delete (Arena *a, stree *t, int val)
+{
+  stree *target = find_loc (t, val);
+  if (*target)
+    {
+      stree n = *target;
+      if (!(n->left && n->right))
+        {
+          *target = n->left ? n->left : n->right;
+          free_node (a, n);
+        }
+      else
+        {
+          stree *rm_ref = rightmost (&n->left);
+          stree  rm     = *rm_ref;
+          n->value      = rm->value;
+          *rm_ref       = rm->left;
+          free_node (a, rm);
+        }
+    }
+}
+
+// With an arena, that's free_arena(). Otherwise the nodes are freed one by one as in free_nodes() of
+// 12_4_iterative.c, threading the tree instead of using a stack.
+void
+free_nodes (Arena *a, Node *curr)
+{
+  if (a)
+    {
+      free_arena (a);
+      return;
+    }
+  while (curr)
+    {
+      if (!curr->left)
+        {
+          Node *right = curr->right;
+          free (curr);
+          curr = right;
+        }
+      else
+        {
+          stree pred  = *rightmost (&curr->left);
+          pred->right = curr;
+          Node *left  = curr->left;
+          curr->left  = EMPTY_TREE;
+          curr        = left;
+        }
+    }
+}
+
+static void
+print_stree_ (stree t)
+{
+  if (!t)
+    {
+      putchar ('_');
+      return;
+    }
+  putchar ('[');
+  print_stree_ (t->left);
+  printf (",%d,", t->value);
+  print_stree_ (t->right);
+  putchar (']');
+}
+
+void
+print_stree (stree *t)
+{
+  print_stree_ (*t);
+  putchar ('\n');
+}
+
+// -------------------- 32-bit Indices -------------------------------------------------------------
+
+typedef struct node32
+{
+  int      value;
+  uint32_t left; // index into stree32.nodes, 0 for the empty tree
+  uint32_t right;
+} Node32;
+
+typedef struct stree32
+{
+  Node32  *nodes;     // nodes[0] is never used
+  uint32_t root;      // 0 for the empty tree
+  uint32_t used;      // nodes[1] … nodes[used - 1] have been handed out
+  uint32_t cap;       // length of `nodes`
+  uint32_t free_list; // freed nodes, linked through `left`
+} STree32;
+
+STree32 *
+new_stree32 (void)
+{
+  STree32 *t = malloc (sizeof *t);
+  if (t)
+    {
+      *t = (STree32){ .used = 1 };
+    }
+  return t;
+}
+
+void
+free_stree32 (STree32 *t)
+{
+  free (t->nodes);
+  free (t);
+}
+
+// Makes sure that new_node32() has a node to give. Call it before taking the address of an index in `nodes`:
+// growing the array moves the nodes.
+static bool
+reserve32 (STree32 *t)
+{
+  if (t->free_list || t->used < t->cap)
+    {
+      return true;
+    }
+  if (t->cap == UINT32_MAX)
+    {
+      return false;
+    }
+  uint32_t cap   = t->cap > UINT32_MAX / 2 ? UINT32_MAX : t->cap ? 2 * t->cap : 1024;
+  Node32  *nodes = realloc (t->nodes, (size_t)cap * sizeof *nodes);
+  if (!nodes)
+    {
+      return false;
+    }
+  t->nodes = nodes;
+  t->cap   = cap;
+  return true;
+}
+
+static uint32_t
+new_node32 (STree32 *t, int value)
+{
+  uint32_t i;
+  if (t->free_list)
+    {
+      i            = t->free_list;
+      t->free_list = t->nodes[i].left;
+    }
+  else
+    {
+      i = t->used++;
+    }
+  t->nodes[i] = (Node32){ .value = value };
+  return i;
+}
+
+static void
+free_node32 (STree32 *t, uint32_t i)
+{
+  t->nodes[i].left = t->free_list;
+  t->free_list     = i;
+}
+
+uint32_t *
+find_loc32 (STree32 *t, int val)
+{
+  uint32_t *loc = &t->root;
+  while (*loc && val != t->nodes[*loc].value)
+    {
+      loc = val < t->nodes[*loc].value ? &t->nodes[*loc].left : &t->nodes[*loc].right;
+    }
+  return loc;
+}
+
+bool
+contains32 (STree32 *t, int val)
+{
+  return !!*find_loc32 (t, val);
+}
+
+bool
+insert32 (STree32 *t, int val)
+{
+  if (!reserve32 (t))
+    {
+      return false;
+    }
+  uint32_t *loc = find_loc32 (t, val);
+  if (!*loc)
+    {
+      *loc = new_node32 (t, val);
+    }
+  return true;
+}
+
+void
+delete32 (STree32 *t, int val)
+{
+  uint32_t *target = find_loc32 (t, val);
+  if (*target)
+    {
+      Node32 *n = &t->nodes[*target];
+      if (!(n->left && n->right))
+        {
+          uint32_t i = *target;
+          *target    = n->left ? n->left : n->right;
+          free_node32 (t, i);
+        }
+      else
+        {
+          uint32_t *rm_ref = &n->left;
+          while (t->nodes[*rm_ref].right)
+            {
+              rm_ref = &t->nodes[*rm_ref].right;
+            }
+          uint32_t rm = *rm_ref;
+          n->value    = t->nodes[rm].value;
+          *rm_ref     = t->nodes[rm].left;
+          free_node32 (t, rm);
+        }
+    }
+}
+
+static void
+print_stree32_ (STree32 *t, uint32_t i)
+{
+  if (!i)
+    {
+      putchar ('_');
+      return;
+    }
+  putchar ('[');
+  print_stree32_ (t, t->nodes[i].left);
+  printf (",%d,", t->nodes[i].value);
+  print_stree32_ (t, t->nodes[i].right);
+  putchar (']');
+}
+
+void
+print_stree32 (STree32 *t)
+{
+  print_stree32_ (t, t->root);
+  putchar ('\n');
+}
+
+// -------------------- Benchmark ------------------------------------------------------------------
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+xorshift (unsigned *state)
+{
+  unsigned x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+// Inserts n random keys, looks up n random keys (about half of them are there), and frees the tree: with nodes from
+// malloc(), from an arena, and as 32-bit indices. The bytes per node count what the nodes were allocated in, not
+// malloc()'s own overhead (16 bytes per block with glibc: a malloc()'d node takes 32 bytes).
+// Build with `make CFLAGS=-O2\ -DNDEBUG`, then run `./12_10_arena 10000000`.
+void
+benchmark (int n)
+{
+  printf ("%d keys:\n", n);
+  for (int mode = 0; mode < 3; mode++)
+    {
+      unsigned seed  = 1;
+      Arena    arena = { 0 };
+      Arena   *a     = mode == 1 ? &arena : NULL;
+      stree    t     = EMPTY_TREE;
+      STree32 *t32   = mode == 2 ? new_stree32 () : NULL;
+      int      found = 0;
+      size_t   nodes = 0;
+      double   bytes = 0;
+      clock_t  start = clock ();
+      if (mode == 2 && !t32)
+        {
+          abort ();
+        }
+      for (int i = 0; i < n; i++)
+        {
+          int  key = xorshift (&seed) % (2u * n);
+          bool ok  = mode == 2 ? insert32 (t32, key) : insert (a, &t, key);
+          if (!ok)
+            {
+              abort ();
+            }
+        }
+      double t_insert = seconds_since (start);
+      start           = clock ();
+      for (int i = 0; i < n; i++)
+        {
+          int key = xorshift (&seed) % (2u * n);
+          found += mode == 2 ? contains32 (t32, key) : contains (&t, key);
+        }
+      double t_find = seconds_since (start);
+      if (mode == 2)
+        {
+          nodes = t32->used - 1;
+          bytes = (double)t32->cap * sizeof (Node32);
+        }
+      else
+        {
+          for (Chunk *c = arena.chunks; c; c = c->next)
+            {
+              nodes += c == arena.chunks ? arena.used : CHUNK_NODES;
+              bytes += sizeof (Chunk);
+            }
+        }
+      start = clock ();
+      if (mode == 2)
+        {
+          free_stree32 (t32);
+        }
+      else
+        {
+          free_nodes (a, t);
+        }
+      double t_free = seconds_since (start);
+
+      char const *names[] = { "malloc", "arena", "32-bit" };
+      printf ("  %-7s insert %.3fs, find %.3fs (%d found), free %.3fs, %.1f bytes/node\n", names[mode], t_insert,
+              t_find, found, t_free, mode == 0 ? (double)sizeof (Node) : bytes / nodes);
+    }
+}
+
+// -------------------- Main -----------------------------------------------------------------------
+
+int
+main (int argc, char *argv[])
+{
+  int array[] = { 3, 2, 1, 6, 10, 0 };
+  int n       = sizeof array / sizeof *array;
+
+  printf ("== Arena ===========================\n");
+  Arena a = { 0 };
+  stree t = EMPTY_TREE;
+  for (int i = 0; i < n; i++)
+    {
+      insert (&a, &t, array[i]);
+    }
+  print_stree (&t);
+  delete (&a, &t, 12);
+  delete (&a, &t, 3);
+  delete (&a, &t, 6);
+  assert (!contains (&t, 3) && !contains (&t, 6) && contains (&t, 10));
+  print_stree (&t);
+  insert (&a, &t, 4); // takes the node of 6 from the free list
+  assert (a.free_list && a.used == n);
+  print_stree (&t);
+  free_nodes (&a, t);
+
+  printf ("== 32-bit indices ==================\n");
+  STree32 *t32 = new_stree32 ();
+  if (!t32)
+    {
+      abort ();
+    }
+  for (int i = 0; i < n; i++)
+    {
+      insert32 (t32, array[i]);
+    }
+  print_stree32 (t32);
+  delete32 (t32, 12);
+  delete32 (t32, 3);
+  delete32 (t32, 6);
+  assert (!contains32 (t32, 3) && !contains32 (t32, 6) && contains32 (t32, 10));
+  print_stree32 (t32);
+  insert32 (t32, 4);
+  print_stree32 (t32);
+  free_stree32 (t32);
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]));
+    }
+}
@@ -1,7 +1,10 @@
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 // ------------------------- Tree  ------------------------------------------------- //
 
@@ -17,26 +20,78 @@ typedef node_t *STree;
 #define EMPTY_STREE NULL
 #define EMPTY_NODE  NULL
 
+// Every node is preceded by the slab it was taken from, NULL for a node of its own (see Slabs below).
+typedef struct cell
+{
+  struct slab *slab;
+  node_t       node;
+} Cell;
+
+#define cell_of(n) ((Cell *)((char *)(n) - offsetof (Cell, node)))
+
 int allocated;
 
 STree
 node (int value, STree left, STree right)
 {
-  STree t = malloc (sizeof *t);
-  if (t)
+  Cell *c = malloc (sizeof *c);
+  if (!c)
     {
-      allocated++;
-      *t = (node_t){
-        .value = value,
-        .left  = left,
-        .right = right,
-      };
+      return NULL;
     }
-  return t;
+  allocated++;
+  *c = (Cell){
+    .slab = NULL,
+    .node = { .value = value, .left = left, .right = right },
+  };
+  return &c->node;
 }
 
 #define leaf(value) node (value, EMPTY_STREE, EMPTY_STREE)
 
+// ------------------------- Slabs ------------------------------------------------- //
+
+// stree_from_sorted() takes all nodes of a tree from one allocation, a slab. Its nodes can be deleted like any other
+// node: free_node() finds the slab in front of the node, and frees it together with its last node.
+typedef struct slab
+{
+  int  live; // nodes not freed yet
+  Cell cells[];
+} Slab;
+
+Slab *
+new_slab (int n)
+{
+  Slab *slab = malloc (sizeof *slab + n * sizeof (Cell));
+  if (!slab)
+    {
+      return NULL;
+    }
+  slab->live = n;
+  for (int i = 0; i < n; i++)
+    {
+      slab->cells[i].slab = slab;
+    }
+  allocated += n;
+  return slab;
+}
+
+// Frees a node from node() or from a slab.
+void
+free_node (node_t *n)
+{
+  allocated--;
+  Slab *slab = cell_of (n)->slab;
+  if (!slab)
+    {
+      free (cell_of (n));
+    }
+  else if (--slab->live == 0)
+    {
+      free (slab);
+    }
+}
+
 STree *
 new_stree ()
 {
@@ -78,8 +133,7 @@ free_nodes (node_t *n)
         {
           // free current node and recurse right
           node_t *right = curr->right;
-          free (curr);
-          allocated--;
+          free_node (curr);
           curr = right;
         }
       else
@@ -158,8 +212,7 @@ void delete (STree *tree, int val)
       if (!(t->left && t->right))
         {
           *target = t->left ? t->left : t->right;
-          free (t);
-          allocated--;
+          free_node (t);
         }
       else
         {
@@ -167,8 +220,7 @@ void delete (STree *tree, int val)
           STree  rm     = *rm_ref;
           t->value      = rm->value;
           *rm_ref       = rm->left;
-          free (rm);
-          allocated--;
+          free_node (rm);
         }
     }
 }
@@ -318,10 +370,401 @@ cleanup_iter (StreeIter *iter)
     }
 }
 
+// ------------------------- Stack Iterators --------------------------------------- //
+
+// An in-order iterator that only reads the tree, so any number of them, in any number of threads, can walk a tree at
+// the same time, and one can be dropped at any point (after free_stack_iter()). Morris traversal needs no memory but
+// threads the tree while it walks. This iterator keeps the nodes whose right subtrees are still to come on a stack,
+// at most one per level: in the iterator itself for trees up to ITER_STACK high, on the heap for higher ones.
+#define ITER_STACK 32
+
+typedef struct stack_iter
+{
+  node_t  *curr;              // the subtree to descend into next
+  int      top;               // number of nodes on the stack
+  int      capacity;
+  node_t  *fixed[ITER_STACK]; // the stack while it fits …
+  node_t **heap;              // … and once it doesn't
+} StackIter;
+
+StackIter
+stack_iter (STree *t)
+{
+  return (StackIter){ .curr = *t, .capacity = ITER_STACK };
+}
+
+static bool
+push (StackIter *iter, node_t *n)
+{
+  if (iter->top == iter->capacity)
+    {
+      int      capacity = 2 * iter->capacity;
+      node_t **heap     = realloc (iter->heap, capacity * sizeof *heap);
+      if (!heap)
+        {
+          return false;
+        }
+      if (!iter->heap)
+        {
+          memcpy (heap, iter->fixed, sizeof iter->fixed);
+        }
+      iter->heap     = heap;
+      iter->capacity = capacity;
+    }
+  (iter->heap ? iter->heap : iter->fixed)[iter->top++] = n;
+  return true;
+}
+
+// returns next node or NULL if there are no nodes left (or no memory for a larger stack)
+node_t *
+stack_next (StackIter *iter)
+{
+  for (; iter->curr; iter->curr = iter->curr->left)
+    {
+      if (!push (iter, iter->curr))
+        {
+          return NULL;
+        }
+    }
+  if (iter->top == 0)
+    {
+      return NULL;
+    }
+  node_t *n  = (iter->heap ? iter->heap : iter->fixed)[--iter->top];
+  iter->curr = n->right;
+  return n;
+}
+
+void
+free_stack_iter (StackIter *iter)
+{
+  free (iter->heap);
+  iter->heap = NULL;
+}
+
+// ------------------------- Balancing --------------------------------------------- //
+
+// Rotates the first `count` odd nodes of the vine below `root` (a chain of right pointers) to the left, so each becomes
+// the left child of its successor.
+static void
+compress (node_t *root, int count)
+{
+  node_t *scanner = root;
+  for (int i = 0; i < count; i++)
+    {
+      node_t *child  = scanner->right;
+      scanner->right = child->right;
+      scanner        = scanner->right;
+      child->right   = scanner->left;
+      scanner->left  = child;
+    }
+}
+
+// Turns a vine of n nodes (sorted, linked by right pointers, left pointers empty) into a tree of minimal height, in
+// O(n) time and without a stack: first the nodes that end up in the lowest, incomplete level are rotated down, then
+// each pass halves the vine (Day, Stout and Warren).
+static STree
+vine_to_tree (node_t *vine, int n)
+{
+  node_t root = { .right = vine }; // pseudo root
+  long   full = 1;                 // largest 2^k - 1 ≤ n nodes make a complete tree
+  while (2 * full + 1 <= n)
+    {
+      full = 2 * full + 1;
+    }
+  compress (&root, n - full);
+  for (int size = full; size > 1; size /= 2)
+    {
+      compress (&root, size / 2);
+    }
+  return root.right;
+}
+
+// Builds a tree of minimal height from `n` sorted values in O(n), with one allocation for all nodes (see Slabs).
+// Returns NULL if there is no memory or the values aren't strictly increasing.
+STree *
+stree_from_sorted (int n, int array[n])
+{
+  for (int i = 1; i < n; i++)
+    {
+      if (array[i - 1] >= array[i])
+        {
+          return NULL;
+        }
+    }
+  STree *t    = new_stree ();
+  Slab  *slab = t && n ? new_slab (n) : NULL;
+  if (!t || (n && !slab))
+    {
+      free (t);
+      return NULL;
+    }
+  for (int i = 0; i < n; i++)
+    {
+      slab->cells[i].node = (node_t){ .value = array[i], .right = i + 1 < n ? &slab->cells[i + 1].node : EMPTY_NODE };
+    }
+  *t = vine_to_tree (n ? &slab->cells[0].node : EMPTY_NODE, n);
+  return t;
+}
+
+// Rebalances a tree in O(n) time and O(1) space. The iterator visits the nodes in order (Morris traversal); each node
+// is chained to its predecessor through its left pointer, which the traversal doesn't need any more once the node is
+// visited. The chain is then turned around into a vine and the vine into a tree.
+void
+rebalance (STree *tree)
+{
+  StreeIter iter = stree_iter (tree);
+  node_t   *prev = EMPTY_NODE;
+  node_t   *curr;
+  int       n = 0;
+  while ((curr = next_node (&iter)))
+    {
+      curr->left = prev;
+      prev       = curr;
+      n++;
+    }
+  node_t *vine = EMPTY_NODE;
+  while (prev)
+    {
+      node_t *left = prev->left;
+      prev->left   = EMPTY_NODE;
+      prev->right  = vine;
+      vine         = prev;
+      prev         = left;
+    }
+  *tree = vine_to_tree (vine, n);
+}
+
+int
+height (STree t)
+{
+  if (!t)
+    {
+      return 0;
+    }
+  int l = height (t->left);
+  int r = height (t->right);
+  return 1 + (l > r ? l : r);
+}
+
+// ------------------------- Frozen Trees ------------------------------------------ //
+
+// A read-only copy of a tree in an array, without pointers, in Eytzinger order: the root is at index 1, and the
+// children of index k are at 2k and 2k + 1, as in a binary heap. A lookup walks down the array with no branch on the
+// values; the first levels are in the same few cache lines, and the prefetch fetches the 16 descendants four levels
+// down, which sit in one cache line, while the walk is still on its way there.
+typedef struct frozen
+{
+  int  n;
+  int *values; // values[1 … n]; 64-byte aligned
+} Frozen;
+
+// The index that comes after k in order (0 at the end), in an implicit tree of n nodes.
+static int
+next_index (int k, int n)
+{
+  if (2 * k + 1 <= n)
+    { // leftmost node of the right subtree
+      for (k = 2 * k + 1; 2 * k <= n; k *= 2)
+        {
+          ;
+        }
+      return k;
+    }
+  while (k & 1)
+    {
+      k /= 2; // up from a right child
+    }
+  return k / 2;
+}
+
+void
+free_frozen (Frozen *f)
+{
+  free (f->values);
+  free (f);
+}
+
+// Copies the tree into a new Frozen array; the tree itself is left as it is. Returns NULL if there is no memory.
+Frozen *
+stree_freeze (STree *tree)
+{
+  int       n  = 0;
+  StackIter it = stack_iter (tree);
+  while (stack_next (&it))
+    {
+      n++;
+    }
+  free_stack_iter (&it);
+  Frozen *f      = malloc (sizeof *f);
+  size_t  bytes  = ((n + 1) * sizeof (int) + 63) / 64 * 64;
+  int    *values = aligned_alloc (64, bytes);
+  if (!f || !values)
+    {
+      free (f);
+      free (values);
+      return NULL;
+    }
+  *f = (Frozen){ .n = n, .values = values };
+
+  int k = n ? 1 : 0;
+  while (k && 2 * k <= n)
+    {
+      k *= 2; // the leftmost node comes first
+    }
+  it = stack_iter (tree);
+  for (node_t *x; k && (x = stack_next (&it)); k = next_index (k, n))
+    {
+      values[k] = x->value;
+    }
+  free_stack_iter (&it);
+  if (k)
+    { // the walk stopped early: no memory for the iterator's stack
+      free_frozen (f);
+      return NULL;
+    }
+  return f;
+}
+
+bool
+frozen_contains (Frozen *f, int val)
+{
+  size_t k = 1;
+  while (k <= (size_t)f->n)
+    {
+      __builtin_prefetch (f->values + 16 * k);
+      k = 2 * k + (f->values[k] < val); // right if the value is smaller
+    }
+  // k went past a leaf; the turns after the last left turn lead away from the first value ≥ val, so drop them
+  k >>= __builtin_ffsl (~k);
+  return k && f->values[k] == val;
+}
+
+// ------------------------- Benchmark --------------------------------------------- //
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Walks the tree with the Morris iterator and with the stack iterator.
+void
+time_iterators (STree *t, char const *name)
+{
+  long      sum    = 0;
+  clock_t   start  = clock ();
+  StreeIter morris = stree_iter (t);
+  for (node_t *x; (x = next_node (&morris));)
+    {
+      sum += x->value;
+    }
+  double t_morris = seconds_since (start);
+
+  start         = clock ();
+  StackIter stk = stack_iter (t);
+  for (node_t *x; (x = stack_next (&stk));)
+    {
+      sum -= x->value;
+    }
+  double t_stack = seconds_since (start);
+  size_t bytes   = sizeof stk + (stk.heap ? stk.capacity * sizeof *stk.heap : 0);
+
+  printf ("  iterating %-10s Morris %.3fs (%zu bytes), stack %.3fs (%zu bytes%s)%s\n", name, t_morris, sizeof morris,
+          t_stack, bytes, stk.heap ? ", stack on the heap" : "", sum ? ", DIFFERENT" : "");
+  free_stack_iter (&stk);
+}
+
+// Looks up n random values, half of them in the tree, in the tree and in its frozen copy.
+void
+time_frozen (STree *t, int n, char const *name)
+{
+  clock_t start  = clock ();
+  Frozen *frozen = stree_freeze (t);
+  double  t_copy = seconds_since (start);
+  if (!frozen)
+    {
+      abort ();
+    }
+  int found = 0;
+  srand (2);
+  start = clock ();
+  for (int i = 0; i < n; i++)
+    {
+      found += contains (t, rand () % (4 * n));
+    }
+  double t_tree = seconds_since (start);
+  srand (2);
+  start = clock ();
+  for (int i = 0; i < n; i++)
+    {
+      found -= frozen_contains (frozen, rand () % (4 * n));
+    }
+  double t_frozen = seconds_since (start);
+  printf ("  looking up %-9s tree %.3fs, frozen %.3fs (%.1f MB, frozen in %.3fs)%s\n", name, t_tree, t_frozen,
+          frozen->n * sizeof (int) / 1e6, t_copy, found ? ", DIFFERENT" : "");
+  free_frozen (frozen);
+}
+
+// Builds a tree from n sorted values with stree_from_sorted(), and from the same values in random order with
+// make_stree_from_array() (inserting them in sorted order would make a list), which rebalance() then balances.
+// Build with `make CFLAGS=-O2\ -DNDEBUG`, then run `./12_7_morris 10000000`.
+void
+benchmark (int n)
+{
+  int *array = malloc (n * sizeof *array);
+  if (!array)
+    {
+      abort ();
+    }
+  for (int i = 0; i < n; i++)
+    {
+      array[i] = 2 * i;
+    }
+  printf ("%d values:\n", n);
+  clock_t start  = clock ();
+  STree  *sorted = stree_from_sorted (n, array);
+  double  t_bulk = seconds_since (start);
+  if (!sorted)
+    {
+      abort ();
+    }
+  printf ("  stree_from_sorted      %.3fs, height %d\n", t_bulk, height (*sorted));
+
+  srand (1);
+  for (int i = n - 1; i > 0; i--)
+    {
+      int j    = rand () % (i + 1);
+      int x    = array[i];
+      array[i] = array[j];
+      array[j] = x;
+    }
+  start           = clock ();
+  STree *shuffled = make_stree_from_array (n, array);
+  double t_insert = seconds_since (start);
+  if (!shuffled)
+    {
+      abort ();
+    }
+  printf ("  make_stree_from_array  %.3fs, height %d\n", t_insert, height (*shuffled));
+  time_iterators (shuffled, "random");
+  time_frozen (shuffled, n, "random");
+
+  start = clock ();
+  rebalance (shuffled);
+  double t_rebalance = seconds_since (start);
+  printf ("  rebalance              %.3fs, height %d\n", t_rebalance, height (*shuffled));
+  time_iterators (shuffled, "rebalanced");
+  time_frozen (shuffled, n, "rebalanced");
+  free_stree (sorted);
+  free_stree (shuffled);
+  free (array);
+}
+
 // ------------------------- Main -------------------------------------------------- //
 
 int
-main ()
+main (int argc, char *argv[])
 {
   printf ("========== Tree from array ===================\n");
   int    array[] = { 1, 2, 13, 4, 16, 8, 10 };
@@ -344,12 +787,58 @@ main ()
     }
   cleanup_iter (&iter);
 
+  printf ("\n========== Two stack iterators ===============\n");
+  StackIter a = stack_iter (t);
+  StackIter b = stack_iter (t);
+  stack_next (&b); // one ahead
+  for (node_t *x, *y; (x = stack_next (&a)) && (y = stack_next (&b));)
+    {
+      printf ("(%d %d) ", x->value, y->value);
+    }
+  free_stack_iter (&a);
+  free_stack_iter (&b);
+
+  printf ("\n========== Frozen ============================\n");
+  Frozen *frozen = stree_freeze (t);
+  for (int i = 1; i <= frozen->n; i++)
+    {
+      printf ("%d ", frozen->values[i]);
+    }
+  printf ("\n");
+  for (int val = 0; val <= 17; val++)
+    {
+      assert (frozen_contains (frozen, val) == contains (t, val));
+    }
+  free_frozen (frozen);
+
   printf ("\n========== Free ==============================\n");
   free_stree (t);
   t = make_stree_from_array (n, array);
   print_stree (t);
   free_stree (t);
 
+  printf ("========== Sorted, bulk-built ================\n");
+  int sorted[] = { 1, 2, 4, 8, 10, 13, 16, 20, 22, 25 };
+  n            = sizeof sorted / sizeof *sorted;
+  t            = stree_from_sorted (n, sorted);
+  print_stree (t);
+  delete (t, 10); // nodes of a slab are freed like any other
+  insert (t, 11);
+  print_stree (t);
+  free_stree (t);
+
+  printf ("========== Sorted, inserted, rebalanced ======\n");
+  t = make_stree_from_array (n, sorted);
+  print_stree (t);
+  rebalance (t);
+  print_stree (t);
+  free_stree (t);
+
   printf ("==============================================\n");
   printf ("net allocations = %d\n", allocated);
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]));
+    }
 }
@@ -2,6 +2,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 typedef struct node
 {
@@ -397,8 +398,178 @@ parent_free (stree t)
 
 #define free_nodes parent_free
 
+// ------------------------- Iterators and Ranges ---------------------------------- //
+
+// A node is an iterator: next_node() and prev_node() step to the neighbours in order with the parent pointers, so
+// iterating needs no stack and doesn't change the tree. A step can climb or descend O(height) levels, but a walk over k
+// nodes takes O(k + height) steps. NULL is the position past either end.
+
+node_t *
+leftmost (node_t *n)
+{
+  while (n && n->left)
+    {
+      n = n->left;
+    }
+  return n;
+}
+
+node_t *
+rightmost_node (node_t *n)
+{
+  while (n && n->right)
+    {
+      n = n->right;
+    }
+  return n;
+}
+
+#define first_node(t) leftmost (*(t))
+#define last_node(t)  rightmost_node (*(t))
+
+node_t *
+next_node (node_t *n)
+{
+  if (n->right)
+    {
+      return leftmost (n->right);
+    }
+  while (n->parent && !left_child (n))
+    {
+      n = n->parent; // coming back up from a right subtree: the parent is done, too
+    }
+  return n->parent;
+}
+
+node_t *
+prev_node (node_t *n)
+{
+  if (n->left)
+    {
+      return rightmost_node (n->left);
+    }
+  while (n->parent && left_child (n))
+    {
+      n = n->parent;
+    }
+  return n->parent;
+}
+
+// The first node with a value ≥ val, or NULL; O(height).
+node_t *
+lower_bound (stree *t, int val)
+{
+  node_t *bound = EMPTY;
+  for (node_t *n = *t; n;)
+    {
+      if (n->value >= val)
+        {
+          bound = n; // a candidate; a smaller one can only be on the left
+          n     = n->left;
+        }
+      else
+        {
+          n = n->right;
+        }
+    }
+  return bound;
+}
+
+// The first node with a value > val, or NULL; O(height).
+node_t *
+upper_bound (stree *t, int val)
+{
+  node_t *bound = EMPTY;
+  for (node_t *n = *t; n;)
+    {
+      if (n->value > val)
+        {
+          bound = n;
+          n     = n->left;
+        }
+      else
+        {
+          n = n->right;
+        }
+    }
+  return bound;
+}
+
+// Calls cb (n, arg) for the nodes with values in [lo, hi], in order. Only the path down to lo and the nodes in the
+// range are visited: O(height + number of nodes in range).
+void
+range_for_each (stree *t, int lo, int hi, void (*cb) (node_t *n, void *arg), void *arg)
+{
+  for (node_t *n = lower_bound (t, lo); n && n->value <= hi; n = next_node (n))
+    {
+      cb (n, arg);
+    }
+}
+
+// ------------------------- Benchmark --------------------------------------------- //
+
+static void
+count_node (node_t *n, void *arg)
+{
+  (void)n;
+  (*(long *)arg)++;
+}
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Counts the values in `m` windows [lo, lo + width] of a tree of `n` random values: by walking the whole tree, and
+// with range_for_each(). Build with `make CFLAGS=-O2\ -DNDEBUG`, then run `./12_8_parent 1000000`.
+void
+benchmark (int n, int m, int width)
+{
+  stree t = EMPTY;
+  srand (1);
+  for (int i = 0; i < n; i++)
+    {
+      if (!insert (&t, rand () % (4 * n)))
+        {
+          abort ();
+        }
+    }
+  long    scanned = 0;
+  clock_t start   = clock ();
+  for (int i = 0; i < m; i++)
+    {
+      int lo = rand () % (4 * n);
+      for (node_t *x = first_node (&t); x; x = next_node (x))
+        {
+          scanned += lo <= x->value && x->value <= lo + width;
+        }
+    }
+  double t_scan = seconds_since (start);
+
+  long ranged = 0;
+  srand (1);
+  for (int i = 0; i < n; i++)
+    {
+      rand (); // the same windows as above
+    }
+  start = clock ();
+  for (int i = 0; i < m; i++)
+    {
+      int lo = rand () % (4 * n);
+      range_for_each (&t, lo, lo + width, count_node, &ranged);
+    }
+  double t_range = seconds_since (start);
+
+  printf ("%d windows of width %d in %d values (%ld hits%s): full scan %.3fs, range_for_each %.3fs\n", m, width, n,
+          ranged, scanned == ranged ? "" : ", DIFFERENT", t_scan, t_range);
+  free_nodes (t);
+}
+
+// ------------------------- Main -------------------------------------------------- //
+
 int
-main ()
+main (int argc, char *argv[])
 {
   printf ("========== Original ==========================\n");
   stree t = EMPTY;
@@ -446,8 +617,31 @@ main ()
   print_stree (t2);
   putchar ('\n');
   parent_traverse (*t2);
+
+  printf ("\n========== Ranges ============================\n");
+  printf ("lower_bound (5) = %d, upper_bound (8) = %d, upper_bound (16) = %p\n", lower_bound (t2, 5)->value,
+          upper_bound (t2, 8)->value, (void *)upper_bound (t2, 16));
+  printf ("[4, 13] forwards: ");
+  for (node_t *x = lower_bound (t2, 4); x && x->value <= 13; x = next_node (x))
+    {
+      printf ("%d ", x->value);
+    }
+  printf ("\n[4, 13] backwards: ");
+  node_t *end = upper_bound (t2, 13);
+  for (node_t *x = end ? prev_node (end) : last_node (t2); x && x->value >= 4; x = prev_node (x))
+    {
+      printf ("%d ", x->value);
+    }
+  long count = 0;
+  range_for_each (t2, 3, 12, count_node, &count);
+  printf ("\n%ld values in [3, 12]\n", count);
   free_stree (t2);
 
   printf ("\n==============================================\n");
   printf ("net allocations = %d\n", allocated);
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]), 100, 100);
+    }
 }
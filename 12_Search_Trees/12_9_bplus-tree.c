@@ -0,0 +1,702 @@
+// A B+-tree: a search tree with many keys per node, so a lookup touches a handful of nodes instead of log2(n).
+// The nodes are NODE_SIZE bytes, four cache lines, and aligned to them. All keys are in the leaves; the inner nodes
+// only hold separators. The leaves are linked in order, so a range scan walks along them without going back up.
+// The search in a node doesn't branch on the keys: it counts the keys that are smaller than the value, over all slots
+// of the node (unused slots hold INT_MAX), which the compiler turns into SIMD compares.
+// The search trees of the other files, e.g. 12_4_iterative.c, need one malloc'd node per value and a dependent cache
+// miss per level; see benchmark().
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NODE_SIZE  256 // bytes
+#define CACHE_LINE 64
+#define LEAF_KEYS  60
+#define INNER_KEYS 20
+#define LEAF_MIN   (LEAF_KEYS / 2) // fewer keys than this, and a node is merged with or refilled from a neighbour
+#define INNER_MIN  (INNER_KEYS / 2)
+
+typedef struct leaf
+{
+  int          n;               // number of keys
+  int          keys[LEAF_KEYS]; // sorted; keys[n] … are INT_MAX
+  struct leaf *next;            // the next leaf, in order
+} Leaf;
+
+typedef struct inner
+{
+  int   n;                        // number of keys; there are n + 1 children
+  int   keys[INNER_KEYS];         // keys[i] ≥ every key below children[i] and < every key below children[i + 1]
+  void *children[INNER_KEYS + 1]; // inner nodes, or leaves on the lowest level
+} Inner;
+
+_Static_assert (sizeof (Leaf) == NODE_SIZE && sizeof (Inner) == NODE_SIZE, "a node fills NODE_SIZE bytes");
+
+typedef struct btree
+{
+  void *root;   // a leaf if height is 0
+  int   height; // number of levels of inner nodes
+} BTree;
+
+// -------------------- Nodes ----------------------------------------------------------------------
+
+static void *
+new_node (void)
+{
+  void *n = aligned_alloc (CACHE_LINE, NODE_SIZE);
+  if (n)
+    {
+      memset (n, 0, NODE_SIZE);
+    }
+  return n;
+}
+
+// Marks the slots from n on as unused.
+static inline void
+pad (int *keys, int n, int size)
+{
+  for (int i = n; i < size; i++)
+    {
+      keys[i] = INT_MAX;
+    }
+}
+
+// Number of keys < val. There's no early exit, so the loop has no branches and is vectorized; the unused slots are
+// INT_MAX and never counted.
+static inline int
+rank (int const *keys, int size, int val)
+{
+  int r = 0;
+  for (int i = 0; i < size; i++)
+    {
+      r += keys[i] < val;
+    }
+  return r;
+}
+
+// The leaf that holds `val` if it is in the tree.
+static Leaf *
+find_leaf (BTree *t, int val)
+{
+  void *n = t->root;
+  for (int h = t->height; h > 0; h--)
+    {
+      Inner *in = n;
+      n         = in->children[rank (in->keys, INNER_KEYS, val)];
+    }
+  return n;
+}
+
+// Distributes `total` sorted keys over two leaves, about half each; returns the largest key of the left one.
+static int
+fill_leaves (Leaf *left, Leaf *right, int total, int keys[total])
+{
+  left->n  = (total + 1) / 2;
+  right->n = total - left->n;
+  memcpy (left->keys, keys, left->n * sizeof *keys);
+  memcpy (right->keys, keys + left->n, right->n * sizeof *keys);
+  pad (left->keys, left->n, LEAF_KEYS);
+  pad (right->keys, right->n, LEAF_KEYS);
+  return left->keys[left->n - 1];
+}
+
+// Distributes `total` keys and `total + 1` children over two inner nodes; the key in the middle separates them, and
+// is returned instead of stored.
+static int
+fill_inners (Inner *left, Inner *right, int total, int keys[total], void *children[total + 1])
+{
+  left->n  = total / 2;
+  right->n = total - left->n - 1;
+  memcpy (left->keys, keys, left->n * sizeof *keys);
+  memcpy (left->children, children, (left->n + 1) * sizeof *children);
+  memcpy (right->keys, keys + left->n + 1, right->n * sizeof *keys);
+  memcpy (right->children, children + left->n + 1, (right->n + 1) * sizeof *children);
+  pad (left->keys, left->n, INNER_KEYS);
+  pad (right->keys, right->n, INNER_KEYS);
+  return keys[left->n];
+}
+
+static void
+free_nodes (void *n, int height)
+{
+  if (height > 0)
+    {
+      Inner *in = n;
+      for (int i = 0; i <= in->n; i++)
+        {
+          free_nodes (in->children[i], height - 1);
+        }
+    }
+  free (n);
+}
+
+// -------------------- Tree -----------------------------------------------------------------------
+
+BTree *
+new_btree (void)
+{
+  BTree *t    = malloc (sizeof *t);
+  Leaf  *root = new_node ();
+  if (!t || !root)
+    {
+      free (t);
+      free (root);
+      return NULL;
+    }
+  pad (root->keys, 0, LEAF_KEYS);
+  *t = (BTree){ .root = root, .height = 0 };
+  return t;
+}
+
+void
+free_btree (BTree *t)
+{
+  free_nodes (t->root, t->height);
+  free (t);
+}
+
+bool
+contains (BTree *t, int val)
+{
+  Leaf *leaf = find_leaf (t, val);
+  int   i    = rank (leaf->keys, LEAF_KEYS, val);
+  return i < leaf->n && leaf->keys[i] == val;
+}
+
+// Inserts `val` below node `n`, `height` levels above the leaves. If `n` was full, its upper half moves to a new
+// node: *split is set to it, and *sep to the key that separates them. Returns false if there is no memory.
+static bool
+insert_below (void *n, int height, int val, void **split, int *sep)
+{
+  *split = NULL;
+  if (height == 0)
+    {
+      Leaf *leaf = n;
+      int   i    = rank (leaf->keys, LEAF_KEYS, val);
+      if (i < leaf->n && leaf->keys[i] == val)
+        {
+          return true; // we have been already here
+        }
+      if (leaf->n < LEAF_KEYS)
+        {
+          memmove (&leaf->keys[i + 1], &leaf->keys[i], (leaf->n - i) * sizeof (int));
+          leaf->keys[i] = val;
+          leaf->n++;
+          return true;
+        }
+      Leaf *right = new_node ();
+      if (!right)
+        {
+          return false;
+        }
+      int keys[LEAF_KEYS + 1];
+      memcpy (keys, leaf->keys, i * sizeof (int));
+      keys[i] = val;
+      memcpy (keys + i + 1, leaf->keys + i, (LEAF_KEYS - i) * sizeof (int));
+      *sep        = fill_leaves (leaf, right, LEAF_KEYS + 1, keys);
+      right->next = leaf->next;
+      leaf->next  = right;
+      *split      = right;
+      return true;
+    }
+
+  // A full node might have to be split when a child is split. The new node is allocated first: it's too late once the
+  // child has been split.
+  Inner *in    = n;
+  int    i     = rank (in->keys, INNER_KEYS, val);
+  Inner *right = in->n == INNER_KEYS ? new_node () : NULL;
+  void  *child_split;
+  int    child_sep;
+  if ((in->n == INNER_KEYS && !right) || !insert_below (in->children[i], height - 1, val, &child_split, &child_sep))
+    {
+      free (right);
+      return false;
+    }
+  if (!child_split)
+    {
+      free (right);
+      return true;
+    }
+  // children[i] was split: child_sep goes to keys[i], child_split to children[i + 1]
+  if (in->n < INNER_KEYS)
+    {
+      memmove (&in->keys[i + 1], &in->keys[i], (in->n - i) * sizeof (int));
+      memmove (&in->children[i + 2], &in->children[i + 1], (in->n - i) * sizeof (void *));
+      in->keys[i]         = child_sep;
+      in->children[i + 1] = child_split;
+      in->n++;
+      return true;
+    }
+  int   keys[INNER_KEYS + 1];
+  void *children[INNER_KEYS + 2];
+  memcpy (keys, in->keys, i * sizeof (int));
+  keys[i] = child_sep;
+  memcpy (keys + i + 1, in->keys + i, (INNER_KEYS - i) * sizeof (int));
+  memcpy (children, in->children, (i + 1) * sizeof (void *));
+  children[i + 1] = child_split;
+  memcpy (children + i + 2, in->children + i + 1, (INNER_KEYS - i) * sizeof (void *));
+  *sep   = fill_inners (in, right, INNER_KEYS + 1, keys, children);
+  *split = right;
+  return true;
+}
+
+bool
+insert (BTree *t, int val)
+{
+  // a new root, in case the root is full and is split
+  bool   full = t->height ? ((Inner *)t->root)->n == INNER_KEYS : ((Leaf *)t->root)->n == LEAF_KEYS;
+  Inner *root = full ? new_node () : NULL;
+  void  *split;
+  int    sep;
+  if ((full && !root) || !insert_below (t->root, t->height, val, &split, &sep))
+    {
+      free (root);
+      return false;
+    }
+  if (!split)
+    {
+      free (root);
+    }
+  else
+    { // the root was split; the tree grows by one level
+      pad (root->keys, 0, INNER_KEYS);
+      root->n           = 1;
+      root->keys[0]     = sep;
+      root->children[0] = t->root;
+      root->children[1] = split;
+      t->root           = root;
+      t->height++;
+    }
+  return true;
+}
+
+// Removes key i and child i + 1 of `in`.
+static void
+remove_entry (Inner *in, int i)
+{
+  memmove (&in->keys[i], &in->keys[i + 1], (in->n - i - 1) * sizeof (int));
+  memmove (&in->children[i + 1], &in->children[i + 2], (in->n - i - 1) * sizeof (void *));
+  in->n--;
+  in->keys[in->n] = INT_MAX;
+}
+
+// children[i] of `in` has too few keys: merge it with a neighbour, or move keys over from the neighbour if both
+// together don't fit into one node.
+static void
+fix_child (Inner *in, int i, int child_height)
+{
+  int l = i < in->n ? i : i - 1; // children[l] and children[l + 1] are merged or refilled
+  if (child_height == 0)
+    {
+      Leaf *left  = in->children[l];
+      Leaf *right = in->children[l + 1];
+      if (left->n + right->n <= LEAF_KEYS)
+        {
+          memcpy (left->keys + left->n, right->keys, right->n * sizeof (int));
+          left->n += right->n;
+          left->next = right->next;
+          free (right);
+          remove_entry (in, l);
+          return;
+        }
+      int keys[2 * LEAF_KEYS];
+      memcpy (keys, left->keys, left->n * sizeof (int));
+      memcpy (keys + left->n, right->keys, right->n * sizeof (int));
+      in->keys[l] = fill_leaves (left, right, left->n + right->n, keys);
+    }
+  else
+    {
+      Inner *left  = in->children[l];
+      Inner *right = in->children[l + 1];
+      if (left->n + 1 + right->n <= INNER_KEYS)
+        {
+          left->keys[left->n] = in->keys[l]; // the separator bounds the last child of left
+          memcpy (left->keys + left->n + 1, right->keys, right->n * sizeof (int));
+          memcpy (left->children + left->n + 1, right->children, (right->n + 1) * sizeof (void *));
+          left->n += 1 + right->n;
+          free (right);
+          remove_entry (in, l);
+          return;
+        }
+      int   keys[2 * INNER_KEYS + 1];
+      void *children[2 * INNER_KEYS + 2];
+      int   total = left->n + 1 + right->n;
+      memcpy (keys, left->keys, left->n * sizeof (int));
+      keys[left->n] = in->keys[l];
+      memcpy (keys + left->n + 1, right->keys, right->n * sizeof (int));
+      memcpy (children, left->children, (left->n + 1) * sizeof (void *));
+      memcpy (children + left->n + 1, right->children, (right->n + 1) * sizeof (void *));
+      in->keys[l] = fill_inners (left, right, total, keys, children);
+    }
+}
+
+// Deletes `val` below node `n`, `height` levels above the leaves. Returns true if `n` has too few keys afterwards.
+static bool
+delete_below (void *n, int height, int val)
+{
+  if (height == 0)
+    {
+      Leaf *leaf = n;
+      int   i    = rank (leaf->keys, LEAF_KEYS, val);
+      if (i < leaf->n && leaf->keys[i] == val)
+        {
+          memmove (&leaf->keys[i], &leaf->keys[i + 1], (leaf->n - i - 1) * sizeof (int));
+          leaf->n--;
+          leaf->keys[leaf->n] = INT_MAX;
+        }
+      return leaf->n < LEAF_MIN;
+    }
+  Inner *in = n;
+  int    i  = rank (in->keys, INNER_KEYS, val);
+  if (delete_below (in->children[i], height - 1, val))
+    {
+      fix_child (in, i, height - 1);
+    }
+  return in->n < INNER_MIN;
+}
+
+void delete (BTree *t, int val)
+{
+  delete_below (t->root, t->height, val);
+  if (t->height > 0 && ((Inner *)t->root)->n == 0)
+    { // the root has a single child left; the tree shrinks by one level
+      Inner *root = t->root;
+      t->root     = root->children[0];
+      t->height--;
+      free (root);
+    }
+}
+
+BTree *
+make_stree_from_array (int n, int array[n])
+{
+  BTree *t = new_btree ();
+  if (!t)
+    {
+      return NULL;
+    }
+  for (int i = 0; i < n; i++)
+    {
+      if (!insert (t, array[i]))
+        {
+          free_btree (t);
+          return NULL;
+        }
+    }
+  return t;
+}
+
+// Copies the keys in [lo, hi] into `out`, at most `max` of them; returns how many.
+int
+range (BTree *t, int lo, int hi, int max, int out[max])
+{
+  int   k    = 0;
+  Leaf *leaf = find_leaf (t, lo);
+  int   i    = rank (leaf->keys, LEAF_KEYS, lo);
+  while (leaf && k < max)
+    {
+      for (; i < leaf->n && k < max; i++)
+        {
+          if (leaf->keys[i] > hi)
+            {
+              return k;
+            }
+          out[k++] = leaf->keys[i];
+        }
+      leaf = leaf->next;
+      i    = 0;
+    }
+  return k;
+}
+
+// -------------------- Printing and Checking ------------------------------------------------------
+
+static void
+print_nodes (void *n, int height)
+{
+  if (height == 0)
+    {
+      Leaf *leaf = n;
+      putchar ('[');
+      for (int i = 0; i < leaf->n; i++)
+        {
+          printf (i ? " %d" : "%d", leaf->keys[i]);
+        }
+      putchar (']');
+      return;
+    }
+  Inner *in = n;
+  putchar ('{');
+  for (int i = 0; i <= in->n; i++)
+    {
+      print_nodes (in->children[i], height - 1);
+      if (i < in->n)
+        {
+          printf (" %d ", in->keys[i]);
+        }
+    }
+  putchar ('}');
+}
+
+void
+print_btree (BTree *t)
+{
+  print_nodes (t->root, t->height);
+  putchar ('\n');
+}
+
+// Checks the order of the keys, the separators, the padding, the fill of the nodes (except the root), and that the
+// leaves are linked in order. Keys below `n` must be in (lo, hi]; *prev is the leaf before the leftmost leaf below n.
+static void
+check_nodes (void *n, int height, bool is_root, long lo, long hi, Leaf **prev)
+{
+  (void)is_root; // only read by the asserts
+  if (height == 0)
+    {
+      Leaf *leaf = n;
+      assert (is_root || leaf->n >= LEAF_MIN);
+      for (int i = 0; i < LEAF_KEYS; i++)
+        {
+          assert (i >= leaf->n ? leaf->keys[i] == INT_MAX : lo < leaf->keys[i] && leaf->keys[i] <= hi);
+          assert (i == 0 || i >= leaf->n || leaf->keys[i - 1] < leaf->keys[i]);
+        }
+      assert (!*prev || (*prev)->next == leaf);
+      *prev = leaf;
+      return;
+    }
+  Inner *in = n;
+  assert (is_root ? in->n >= 1 : in->n >= INNER_MIN);
+  for (int i = 0; i <= in->n; i++)
+    {
+      long l = i == 0 ? lo : in->keys[i - 1];
+      long h = i == in->n ? hi : in->keys[i];
+      assert (l <= h);
+      check_nodes (in->children[i], height - 1, false, l, h, prev);
+    }
+  for (int i = in->n; i < INNER_KEYS; i++)
+    {
+      assert (in->keys[i] == INT_MAX);
+    }
+}
+
+void
+check_btree (BTree *t)
+{
+  Leaf *prev = NULL;
+  check_nodes (t->root, t->height, true, (long)INT_MIN - 1, INT_MAX, &prev);
+  assert (prev->next == NULL);
+}
+
+// -------------------- Benchmark ------------------------------------------------------------------
+
+// The search tree of 12_4_iterative.c, for comparison.
+
+typedef struct node
+{
+  int          value;
+  struct node *left;
+  struct node *right;
+} Node;
+
+typedef Node *stree;
+
+stree *
+find_loc (stree *t, int val)
+{
+  while (*t && val != (*t)->value)
+    {
+      t = val < (*t)->value ? &(*t)->left : &(*t)->right;
+    }
+  return t;
+}
+
+bool
+stree_insert (stree *t, int val)
+{
+  stree *loc = find_loc (t, val);
+  if (!*loc && (*loc = malloc (sizeof **loc)))
+    {
+      **loc = (Node){ .value = val };
+    }
+  return !!*loc;
+}
+
+// Morris traversal, as free_nodes() in 12_4_iterative.c
+void
+stree_free (Node *curr)
+{
+  while (curr)
+    {
+      if (!curr->left)
+        {
+          Node *right = curr->right;
+          free (curr);
+          curr = right;
+        }
+      else
+        {
+          Node *pred = curr->left;
+          while (pred->right)
+            {
+              pred = pred->right;
+            }
+          pred->right = curr;
+          Node *left  = curr->left;
+          curr->left  = NULL;
+          curr        = left;
+        }
+    }
+}
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+xorshift (unsigned *state)
+{
+  unsigned x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+// Inserts n random keys into both trees, then looks up n random keys (about half of them are there).
+// Build with `make CFLAGS=-O2\ -DNDEBUG`, then run `./12_9_bplus-tree 10000000`.
+void
+benchmark (int n)
+{
+  int *keys = malloc (n * sizeof *keys);
+  if (!keys)
+    {
+      abort ();
+    }
+  unsigned seed = 1;
+  for (int i = 0; i < n; i++)
+    {
+      keys[i] = xorshift (&seed) % (2u * n);
+    }
+
+  clock_t start = clock ();
+  stree   bst   = NULL;
+  for (int i = 0; i < n; i++)
+    {
+      if (!stree_insert (&bst, keys[i]))
+        {
+          abort ();
+        }
+    }
+  double t_bst_insert = seconds_since (start);
+  start               = clock ();
+  int found_bst       = 0;
+  for (int i = 0; i < n; i++)
+    {
+      found_bst += !!*find_loc (&bst, xorshift (&seed) % (2u * n));
+    }
+  double t_bst_find = seconds_since (start);
+  stree_free (bst);
+
+  seed                  = 1;
+  start                 = clock ();
+  BTree *btree          = make_stree_from_array (n, keys);
+  double t_btree_insert = seconds_since (start);
+  if (!btree)
+    {
+      abort ();
+    }
+  for (int i = 0; i < n; i++)
+    {
+      xorshift (&seed); // same lookups as above
+    }
+  start           = clock ();
+  int found_btree = 0;
+  for (int i = 0; i < n; i++)
+    {
+      found_btree += contains (btree, xorshift (&seed) % (2u * n));
+    }
+  double t_btree_find = seconds_since (start);
+  free_btree (btree);
+
+  printf ("%d keys, %d of %d lookups found (%s)\n", n, found_btree, n, found_bst == found_btree ? "same" : "DIFFERENT");
+  printf ("  12_4 search tree: insert %.3fs, find %.3fs\n", t_bst_insert, t_bst_find);
+  printf ("  B+-tree:          insert %.3fs, find %.3fs\n", t_btree_insert, t_btree_find);
+  free (keys);
+}
+
+// -------------------- Main -----------------------------------------------------------------------
+
+int
+main (int argc, char *argv[])
+{
+  printf ("---------- 1 … 150 --------------------------------\n");
+  BTree *t = new_btree ();
+  if (!t)
+    {
+      abort ();
+    }
+  for (int i = 150; i > 0; i--)
+    {
+      insert (t, i);
+    }
+  check_btree (t);
+  print_btree (t);
+  assert (contains (t, 1) && contains (t, 150) && !contains (t, 0) && !contains (t, 151));
+
+  printf ("---------- Range 55 … 65 ---------------------------\n");
+  int out[20];
+  int k = range (t, 55, 65, 20, out);
+  for (int i = 0; i < k; i++)
+    {
+      printf ("%d ", out[i]);
+    }
+  printf ("\n");
+
+  printf ("---------- Deleting the even keys ------------------\n");
+  for (int i = 2; i <= 150; i += 2)
+    {
+      delete (t, i);
+      check_btree (t);
+    }
+  print_btree (t);
+  free_btree (t);
+
+  printf ("---------- Random inserts and deletes --------------\n");
+  unsigned seed     = 42;
+  bool     in[5000] = { false };
+  t                 = new_btree ();
+  for (int i = 0; i < 200000; i++)
+    {
+      int val = xorshift (&seed) % 5000;
+      if (xorshift (&seed) % 3)
+        {
+          insert (t, val);
+          in[val] = true;
+        }
+      else
+        {
+          delete (t, val);
+          in[val] = false;
+        }
+    }
+  check_btree (t);
+  (void)in; // only read by the asserts
+  for (int i = 0; i < 5000; i++)
+    {
+      assert (contains (t, i) == in[i]);
+    }
+  printf ("ok, height %d\n", t->height);
+  free_btree (t);
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]));
+    }
+}
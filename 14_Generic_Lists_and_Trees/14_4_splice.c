@@ -0,0 +1,218 @@
+#include "list.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define container(p, type, member) ((type *)((char *)p - offsetof (type, member)))
+
+typedef struct item
+{
+  int  value;
+  link link;
+} item;
+
+item *
+new_item (int value)
+{
+  item *x = malloc (sizeof *x);
+  if (!x)
+    {
+      abort ();
+    }
+  x->value = value;
+  return x;
+}
+
+// --------------- list_api ------------------------------------------------------ //
+
+void
+item_print (link *lnk)
+{
+  printf ("%d", container (lnk, item, link)->value);
+}
+
+void
+item_free (link *lnk)
+{
+  free (container (lnk, item, link));
+}
+
+list_api item_api = {
+  .print = item_print,
+  .free  = item_free,
+};
+
+list *
+new_item_list (int from, int to)
+{
+  list *lst = new_list (item_api);
+  if (!lst)
+    {
+      abort ();
+    }
+  for (int i = from; i < to; i++)
+    {
+      append (lst, &new_item (i)->link);
+    }
+  return lst;
+}
+
+// --------------- predicates ---------------------------------------------------- //
+
+int tick; // items with value % n_ticks == tick are ready
+int n_ticks;
+
+bool
+is_even (link *lnk)
+{
+  return container (lnk, item, link)->value % 2 == 0;
+}
+
+bool
+is_small (link *lnk)
+{
+  return container (lnk, item, link)->value < 5;
+}
+
+bool
+is_ready (link *lnk)
+{
+  return container (lnk, item, link)->value % n_ticks == tick;
+}
+
+// --------------- benchmark ----------------------------------------------------- //
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Move the ready items to the ready queue one at a time.
+void
+move_ready_one_by_one (list *waiting, list *ready)
+{
+  link *lnk = front (waiting);
+  while (lnk != head (waiting))
+    {
+      link *next = lnk->next;
+      if (is_ready (lnk))
+        {
+          unlink (lnk);
+          append (ready, lnk);
+        }
+      lnk = next;
+    }
+}
+
+// Move all links of `from` to the back of `to`, one at a time.
+void
+move_all_one_by_one (list *to, list *from)
+{
+  while (!is_empty (from))
+    {
+      link *lnk = front (from);
+      unlink (lnk);
+      append (to, lnk);
+    }
+}
+
+// A list of `n` items; every tick, the ready items move from `waiting` to `ready`, and back again when they are done.
+// Items are ready in runs of `run` neighbours. Moving them one at a time against delete_if_into() and
+// list_concatenate().
+// Build with `make CFLAGS=-O2`, then run `./14_4_splice 1000000`.
+double
+benchmark_moves (int n, int run, bool batched)
+{
+  // the items are in one array, so both runs start with the same memory layout; the lists don't free them
+  n_ticks       = 16;
+  item *items   = malloc (n * sizeof *items);
+  list *waiting = new_list ((list_api){ .print = item_print });
+  list *ready   = new_list ((list_api){ .print = item_print });
+  if (!items || !waiting || !ready)
+    {
+      abort ();
+    }
+  for (int i = 0; i < n; i++)
+    {
+      items[i].value = i / run;
+      append (waiting, &items[i].link);
+    }
+
+  clock_t start = clock ();
+  for (tick = 0; tick < n_ticks; tick++)
+    {
+      if (batched)
+        {
+          delete_if_into (waiting, is_ready, ready);
+          list_concatenate (waiting, ready);
+        }
+      else
+        {
+          move_ready_one_by_one (waiting, ready);
+          move_all_one_by_one (waiting, ready);
+        }
+    }
+  double t = seconds_since (start);
+
+  free_list (waiting);
+  free_list (ready);
+  free (items);
+  return t;
+}
+
+void
+benchmark (int n, int run)
+{
+  double t_one  = benchmark_moves (n, run, false);
+  double t_into = benchmark_moves (n, run, true);
+  printf ("%d items, runs of %2d, 16 ticks:  one by one %.3fs   batched %.3fs (%.1fx)\n", n, run, t_one, t_into,
+          t_one / t_into);
+}
+
+// --------------- Main ---------------------------------------------------------- //
+
+int
+main (int argc, char *argv[])
+{
+  printf ("Splicing 3 … 5 after 7:\n");
+  printf ("-----------------------\n");
+  list *x     = new_item_list (0, 10);
+  link *first = front (x)->next->next->next;
+  link *last  = first->next->next;
+  link *pos   = back (x)->prev->prev;
+  list_splice (x, pos, first, last);
+  print_list (x);
+
+  printf ("\n\nSplitting at 7, then concatenating the halves the other way round:\n");
+  printf ("------------------------------------------------------------------\n");
+  list *rest = new_list (item_api);
+  list_split_at (x, pos, rest);
+  print_list (x);
+  print_list (rest);
+  list_concatenate (rest, x);
+  print_list (x);
+  print_list (rest);
+
+  printf ("\n\nMoving even numbers, then small numbers:\n");
+  printf ("----------------------------------------\n");
+  list *removed = new_list (item_api);
+  delete_if_into (rest, is_even, removed);
+  print_list (rest);
+  print_list (removed);
+  delete_if_into (rest, is_small, removed);
+  print_list (rest);
+  print_list (removed);
+
+  free_list (x);
+  free_list (rest);
+  free_list (removed);
+
+  if (argc > 1)
+    {
+      int n = atoi (argv[1]);
+      benchmark (n, 1);
+      benchmark (n, 16);
+    }
+}
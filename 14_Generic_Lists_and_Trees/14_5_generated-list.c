@@ -0,0 +1,155 @@
+#include "glist.h"
+#include "list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct number
+{
+  int  value;
+  link link;
+} number;
+
+number *
+new_number (int value)
+{
+  number *x = malloc (sizeof *x);
+  if (!x)
+    {
+      abort ();
+    }
+  x->value = value;
+  return x;
+}
+
+#define free_number(x)   free (x)
+#define print_number(x)  printf ("%d", (x)->value)
+#define is_multiple_3(x) ((x)->value % 3 == 0)
+#define is_negative(x)   ((x)->value < 0)
+#define keep_number(x)   ((void)(x)) // for numbers that live in an array
+
+// --------------- generated ----------------------------------------------------- //
+
+GEN_LIST (number, number, link, free_number, print_number)
+GEN_LIST_PREDICATE (number, number, is_multiple_3)
+GEN_LIST_PREDICATE (number, number, is_negative)
+
+// the same, for numbers in an array that are not freed one by one
+GEN_LIST (anumber, number, link, keep_number, print_number)
+GEN_LIST_PREDICATE (anumber, number, is_multiple_3)
+
+// --------------- list_api ------------------------------------------------------ //
+
+void
+number_print (link *lnk)
+{
+  print_number (container (lnk, number, link));
+}
+
+void
+number_free (link *lnk)
+{
+  free_number (container (lnk, number, link));
+}
+
+bool
+number_is_multiple_3 (link *lnk)
+{
+  return is_multiple_3 (container (lnk, number, link));
+}
+
+list_api number_api = {
+  .print = number_print,
+  .free  = number_free,
+};
+
+// --------------- benchmark ----------------------------------------------------- //
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// delete_if() with a function-pointer predicate against the generated anumber_delete_if_is_multiple_3(), `reps` times
+// on a list of `n` numbers. The numbers sit in one array and nothing is freed, so only the calls are compared (and both
+// versions see the same memory layout).
+// Build with `make CFLAGS=-O2`, then run `./14_5_generated-list 10000000`.
+void
+benchmark (int n, int reps)
+{
+  number *numbers = malloc (n * sizeof *numbers);
+  list   *lst     = new_list ((list_api){ .print = number_print });
+  if (!lst || !numbers)
+    {
+      abort ();
+    }
+
+  double t[2] = { 0, 0 };
+  for (int r = 0; r < reps; r++)
+    {
+      for (int generated = 0; generated < 2; generated++)
+        {
+          *head (lst) = (link){ .prev = head (lst), .next = head (lst) };
+          for (int i = 0; i < n; i++)
+            {
+              numbers[i].value = i;
+              append (lst, &numbers[i].link);
+            }
+
+          clock_t start = clock ();
+          if (generated)
+            {
+              anumber_delete_if_is_multiple_3 (lst);
+            }
+          else
+            {
+              delete_if (lst, number_is_multiple_3);
+            }
+          t[generated] += seconds_since (start);
+        }
+    }
+  printf ("delete_if on %d links, %d times:  pred_fn %.3fs   generated %.3fs (%.1fx)\n", n, reps, t[0], t[1],
+          t[0] / t[1]);
+
+  anumber_free_list (lst);
+  free (numbers);
+}
+
+// --------------- Main ---------------------------------------------------------- //
+
+int
+main (int argc, char *argv[])
+{
+  list *x = new_list (number_api);
+  if (!x)
+    {
+      abort ();
+    }
+  for (int i = -3; i < 10; i++)
+    {
+      append (x, &new_number (i)->link);
+    }
+  number_print_list (x);
+
+  number *n = number_find_is_multiple_3 (x, front (x)->next);
+  printf ("first multiple of 3 after the first number: %d\n", n->value);
+
+  number_delete_if_is_negative (x);
+  number_print_list (x);
+
+  list *removed = new_list (number_api);
+  number_delete_if_is_multiple_3_into (x, removed);
+  number_print_list (x);
+  number_print_list (removed);
+
+  number_free_list (x);
+  free_list (removed); // generated and list_api functions work on the same lists
+
+  if (argc > 1)
+    {
+      int n = atoi (argv[1]);
+      benchmark (n, 1);
+      benchmark (10000, n > 10000 ? n / 10000 : 1); // fits into the cache
+    }
+}
@@ -0,0 +1,154 @@
+#include "stree.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define container(p, type, member) ((type *)((char *)p - offsetof (type, member)))
+
+typedef struct event
+{
+  long timestamp;
+  node node;
+} event;
+
+event *
+new_event (long timestamp)
+{
+  event *e = malloc (sizeof *e);
+  if (!e)
+    {
+      abort ();
+    }
+  e->timestamp = timestamp;
+  return e;
+}
+
+// --------------- stree_api ----------------------------------------------------- //
+
+void const *
+event_key (node *n)
+{
+  return &container (n, event, node)->timestamp;
+}
+
+int
+event_cmp (void const *x, void const *y)
+{
+  long a = *(long const *)x;
+  long b = *(long const *)y;
+  return (a > b) - (a < b);
+}
+
+void
+event_print (node *n)
+{
+  printf ("%ld", container (n, event, node)->timestamp);
+}
+
+void
+event_free (node *n)
+{
+  free (container (n, event, node));
+}
+
+stree_api event_api = {
+  .key   = event_key,
+  .cmp   = event_cmp,
+  .print = event_print,
+  .free  = event_free,
+};
+
+// --------------- height -------------------------------------------------------- //
+
+int
+height (node *n)
+{
+  if (!n)
+    {
+      return 0;
+    }
+  int l = height (n->left);
+  int r = height (n->right);
+  return 1 + (l > r ? l : r);
+}
+
+// --------------- benchmark ----------------------------------------------------- //
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Inserts `n` increasing timestamps, then looks each one up, in an unbalanced and a balanced tree.
+// Build with `make CFLAGS=-O2`, then run `./14_6_balanced-tree 20000`.
+void
+benchmark (int n)
+{
+  for (int balanced = 0; balanced < 2; balanced++)
+    {
+      stree *t = balanced ? new_balanced_tree (event_api) : new_tree (event_api);
+      if (!t)
+        {
+          abort ();
+        }
+      clock_t start = clock ();
+      for (long i = 0; i < n; i++)
+        {
+          insert_node (t, &new_event (i)->node);
+        }
+      double t_insert = seconds_since (start);
+      start           = clock ();
+      for (long i = 0; i < n; i++)
+        {
+          if (!find_node (t, &i))
+            {
+              abort ();
+            }
+        }
+      double t_find = seconds_since (start);
+      printf ("%-10s %d timestamps: height %d, insert %.3fs, find %.3fs\n", balanced ? "balanced" : "unbalanced", n,
+              height (t->root.left), t_insert, t_find);
+      free_tree (t);
+    }
+}
+
+// --------------- Main ---------------------------------------------------------- //
+
+int
+main (int argc, char *argv[])
+{
+  stree *plain    = new_tree (event_api);
+  stree *balanced = new_balanced_tree (event_api);
+  if (!plain || !balanced)
+    {
+      abort ();
+    }
+  for (long i = 1; i <= 15; i++)
+    {
+      insert_node (plain, &new_event (i)->node);
+      insert_node (balanced, &new_event (i)->node);
+    }
+  printf ("unbalanced: ");
+  print_tree (plain);
+  printf ("\n  balanced: ");
+  print_tree (balanced);
+  printf ("\n");
+
+  for (long i = 1; i <= 15; i += 2)
+    {
+      delete_node (balanced, find_node (balanced, &i));
+    }
+  printf ("  balanced, odd timestamps deleted: ");
+  print_tree (balanced);
+  printf ("\n");
+
+  free_tree (plain);
+  free_tree (balanced);
+
+  if (argc > 1)
+    {
+      benchmark (atoi (argv[1]));
+    }
+}
@@ -0,0 +1,307 @@
+#include "list.h"
+#include "stree.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define container(p, type, member) ((type *)((char *)p - offsetof (type, member)))
+
+// The ordered strings of 14_3_tree-list.c, with the insertion order kept in a second tree instead of a list: the
+// strings are numbered as they are added, and that tree is sorted by number. stree_select() then finds the k-th
+// string in O(log n), where take_front() walks k links. The numbers only grow, so it's a balanced tree.
+
+typedef struct ordered_string
+{
+  node        by_str; // in `map`
+  node        by_seq; // in `order`
+  long        seq;
+  char const *str;
+} ordered_string;
+
+void
+free_ordered_string (ordered_string *ostr)
+{
+  remove_node (&ostr->by_str);
+  remove_node (&ostr->by_seq);
+  free (ostr);
+}
+
+// --------------- stree_api ----------------------------------------------------- //
+
+void const *
+str_key (node *n)
+{
+  return container (n, ordered_string, by_str)->str;
+}
+
+int
+str_cmp (void const *x, void const *y)
+{
+  return strcmp (x, y);
+}
+
+void
+str_print (node *n)
+{
+  printf ("\"%s\"", container (n, ordered_string, by_str)->str);
+}
+
+void
+str_free (node *n)
+{
+  free_ordered_string (container (n, ordered_string, by_str));
+}
+
+stree_api str_api = {
+  .key   = str_key,
+  .cmp   = str_cmp,
+  .print = str_print,
+  .free  = str_free,
+};
+
+void const *
+seq_key (node *n)
+{
+  return &container (n, ordered_string, by_seq)->seq;
+}
+
+int
+seq_cmp (void const *x, void const *y)
+{
+  long a = *(long const *)x;
+  long b = *(long const *)y;
+  return (a > b) - (a < b);
+}
+
+void
+seq_free (node *n)
+{
+  free_ordered_string (container (n, ordered_string, by_seq));
+}
+
+stree_api seq_api = {
+  .key  = seq_key,
+  .cmp  = seq_cmp,
+  .free = seq_free,
+};
+
+// --------------- ordered strings ----------------------------------------------- //
+
+typedef struct ordered_strings
+{
+  stree *map;
+  stree *order;
+  long   next_seq;
+} ordered_strings;
+
+ordered_strings *
+new_ordered_strings ()
+{
+  ordered_strings *os = malloc (sizeof *os);
+  if (!os)
+    {
+      abort ();
+    }
+  os->map      = new_tree (str_api);
+  os->order    = new_balanced_tree (seq_api);
+  os->next_seq = 0;
+  if (!os->map || !os->order)
+    {
+      abort ();
+    }
+  return os;
+}
+
+void
+add_string (ordered_strings *oss, char const *str)
+{
+  ordered_string *ostr = malloc (sizeof *ostr);
+  if (!ostr)
+    {
+      abort ();
+    }
+  ostr->str = str;
+  ostr->seq = oss->next_seq++;
+  insert_node (oss->map, &ostr->by_str); // replaces (and frees) a string that is already there
+  insert_node (oss->order, &ostr->by_seq);
+}
+
+void
+remove_string (ordered_strings *oss, char const *str)
+{
+  node *n = find_node (oss->map, str);
+  if (n)
+    {
+      free_ordered_string (container (n, ordered_string, by_str));
+    }
+}
+
+// idx < 0 counts from the back, as in 14_3_tree-list.c.
+ordered_string *
+string_at (ordered_strings *oss, int idx)
+{
+  size_t k = idx < 0 ? stree_size (oss->order) + idx : (size_t)idx; // wraps around for too small indices
+  node  *n = stree_select (oss->order, k);
+  return n ? container (n, ordered_string, by_seq) : NULL;
+}
+
+void
+remove_index (ordered_strings *oss, int idx)
+{
+  ordered_string *x = string_at (oss, idx);
+  if (x)
+    {
+      free_ordered_string (x);
+    }
+}
+
+void
+print_ordered_strings (ordered_strings *oss)
+{
+  printf ("[ ");
+  for (int i = 0; i < (int)stree_size (oss->order); i++)
+    {
+      printf ("\"%s\" ", string_at (oss, i)->str);
+    }
+  printf ("]\n");
+}
+
+void
+free_ordered_strings (ordered_strings *oss)
+{
+  free_tree (oss->map);
+  free_tree (oss->order); // empty by now
+  free (oss);
+}
+
+// --------------- benchmark ----------------------------------------------------- //
+
+typedef struct item
+{
+  long seq;
+  node node;
+  link link;
+} item;
+
+void const *
+item_key (node *n)
+{
+  return &container (n, item, node)->seq;
+}
+
+link *
+take_front (list *lst, int idx)
+{
+  for (link *lnk = front (lst); lnk != head (lst); lnk = lnk->next)
+    {
+      if (idx-- == 0)
+        {
+          return lnk;
+        }
+    }
+  return NULL;
+}
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Finds `m` items by random index, with take_front() in a list of `n` items, and with stree_select() in a tree of the
+// same items. Build with `make CFLAGS=-O2`, then run `./14_7_order-statistics 100000`.
+void
+benchmark (int n, int m)
+{
+  item  *items = malloc (n * sizeof *items);
+  list  *lst   = new_list ((list_api){ 0 });
+  stree *t     = new_balanced_tree ((stree_api){ .key = item_key, .cmp = seq_cmp });
+  int   *idx   = malloc (m * sizeof *idx);
+  if (!items || !lst || !t || !idx)
+    {
+      abort ();
+    }
+  for (int i = 0; i < n; i++)
+    {
+      items[i].seq = i;
+      append (lst, &items[i].link);
+      insert_node (t, &items[i].node);
+    }
+  srand (1);
+  for (int i = 0; i < m; i++)
+    {
+      idx[i] = rand () % n;
+    }
+
+  long    sum   = 0;
+  clock_t start = clock ();
+  for (int i = 0; i < m; i++)
+    {
+      sum += container (take_front (lst, idx[i]), item, link)->seq;
+    }
+  double t_list = seconds_since (start);
+  start         = clock ();
+  for (int i = 0; i < m; i++)
+    {
+      sum -= container (stree_select (t, idx[i]), item, node)->seq;
+    }
+  double t_tree = seconds_since (start);
+  printf ("%d lookups by index among %d items: take_front %.3fs, stree_select %.3fs%s\n", m, n, t_list, t_tree,
+          sum ? " (DIFFERENT)" : "");
+
+  free_tree (t); // frees no items: no free in the api
+  free_list (lst);
+  free (items);
+  free (idx);
+}
+
+// --------------- Main ---------------------------------------------------------- //
+
+int
+main (int argc, char *argv[])
+{
+  ordered_strings *oss = new_ordered_strings ();
+
+  add_string (oss, "foo");
+  add_string (oss, "bar");
+  add_string (oss, "baz");
+  add_string (oss, "qux");
+  add_string (oss, "qax");
+
+  printf ("Original list:\n");
+  printf ("--------------\n");
+  print_ordered_strings (oss);
+  print_tree (oss->map);
+
+  printf ("\n\nRank of \"foo\": %zu; strings in [\"b\", \"foo\"]: %zu\n", stree_rank (oss->map, "foo"),
+          stree_count_range (oss->map, "b", "foo"));
+
+  printf ("\n\nRemoving 'bar':\n");
+  printf ("---------------\n");
+  remove_string (oss, "bar");
+  print_ordered_strings (oss);
+  print_tree (oss->map);
+
+  printf ("\n\nRemoving index 1 (baz):\n");
+  printf ("-----------------------\n");
+  remove_index (oss, 1);
+  print_ordered_strings (oss);
+  print_tree (oss->map);
+
+  printf ("\n\nRemoving index -3 (foo):\n");
+  printf ("------------------------\n");
+  remove_index (oss, -3);
+  print_ordered_strings (oss);
+  print_tree (oss->map);
+
+  printf ("\n\nAll done!\n");
+  free_ordered_strings (oss);
+
+  if (argc > 1)
+    {
+      int n = atoi (argv[1]);
+      benchmark (n, n);
+    }
+}
@@ -0,0 +1,237 @@
+#include "cstree.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define container(p, type, member) ((type *)((char *)p - offsetof (type, member)))
+
+// Readers look up keys in a tree while a writer changes it. The even keys 0, 2, ..., 2n - 2 stay in the tree (the
+// writer only replaces their nodes), so readers must always find them; the writer adds and removes odd keys.
+
+typedef struct item
+{
+  long key;
+  node node;
+} item;
+
+item *
+new_item (long key)
+{
+  item *x = malloc (sizeof *x);
+  if (!x)
+    {
+      abort ();
+    }
+  x->key = key;
+  return x;
+}
+
+// --------------- stree_api ----------------------------------------------------- //
+
+void const *
+item_key (node *n)
+{
+  return &container (n, item, node)->key;
+}
+
+int
+item_cmp (void const *x, void const *y)
+{
+  long a = *(long const *)x;
+  long b = *(long const *)y;
+  return (a > b) - (a < b);
+}
+
+void
+item_free (node *n)
+{
+  free (container (n, item, node));
+}
+
+stree_api item_api = {
+  .key  = item_key,
+  .cmp  = item_cmp,
+  .free = item_free,
+};
+
+// --------------- readers and writer -------------------------------------------- //
+
+// The same tree, behind one mutex (locked) or as a cstree.
+typedef struct shared
+{
+  bool            locked;
+  pthread_mutex_t lock;
+  stree          *tree;
+  cstree         *ctree;
+  long            n;    // the even keys are 0, 2, ..., 2n - 2
+  long            m;    // lookups per reader
+  atomic_bool     done; // the readers are done
+} shared;
+
+typedef struct reader
+{
+  shared   *s;
+  int       id;
+  long      found;
+  long      missed; // even keys not found: must stay 0
+  pthread_t thread;
+} reader;
+
+// xorshift: rand() isn't thread safe
+unsigned long
+next_random (unsigned long *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+void *
+read_keys (void *arg)
+{
+  reader       *r     = arg;
+  shared       *s     = r->s;
+  unsigned long state = 88172645463325252UL + r->id;
+  for (long i = 0; i < s->m; i++)
+    {
+      long key   = next_random (&state) % (2 * s->n);
+      bool found = false;
+      if (s->locked)
+        {
+          pthread_mutex_lock (&s->lock);
+          node *n = find_node (s->tree, &key);
+          found   = n && container (n, item, node)->key == key;
+          pthread_mutex_unlock (&s->lock);
+        }
+      else
+        {
+          cstree_read_lock (s->ctree, r->id);
+          node *n = cstree_find (s->ctree, &key);
+          found   = n && container (n, item, node)->key == key; // n isn't freed before the unlock
+          cstree_read_unlock (s->ctree, r->id);
+        }
+      r->found += found;
+      r->missed += !found && key % 2 == 0;
+    }
+  return NULL;
+}
+
+void *
+write_keys (void *arg)
+{
+  shared       *s      = arg;
+  unsigned long state  = 2463534242UL;
+  long          writes = 0;
+  while (!atomic_load (&s->done))
+    {
+      long key = next_random (&state) % (2 * s->n); // even keys are replaced, odd ones toggled
+      if (s->locked)
+        {
+          pthread_mutex_lock (&s->lock);
+          node *n = find_node (s->tree, &key);
+          if (n && key % 2)
+            {
+              delete_node (s->tree, n);
+            }
+          else
+            {
+              insert_node (s->tree, &new_item (key)->node);
+            }
+          pthread_mutex_unlock (&s->lock);
+        }
+      else if (key % 2 == 0 || !cstree_delete (s->ctree, &key))
+        {
+          cstree_insert (s->ctree, &new_item (key)->node);
+        }
+      writes++;
+    }
+  return (void *)writes;
+}
+
+double
+wall_seconds ()
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Runs `readers` reader threads, with a writer thread if `writer`, on a tree with `n` even keys.
+void
+run (bool locked, int readers, bool writer, long n, long m)
+{
+  shared s = { .locked = locked, .n = n, .m = m };
+  atomic_init (&s.done, false);
+  pthread_mutex_init (&s.lock, NULL);
+  s.ctree = new_cstree (item_api, true, readers);
+  if (!s.ctree)
+    {
+      abort ();
+    }
+  s.tree = s.ctree->tree; // the locked runs use the tree directly
+  for (long key = 0; key < 2 * n; key += 2)
+    {
+      cstree_insert (s.ctree, &new_item (key)->node);
+    }
+
+  reader   *rs    = calloc (readers, sizeof *rs);
+  pthread_t w     = 0;
+  double    start = wall_seconds ();
+  if (!rs || (writer && pthread_create (&w, NULL, write_keys, &s)))
+    {
+      abort ();
+    }
+  for (int i = 0; i < readers; i++)
+    {
+      rs[i] = (reader){ .s = &s, .id = i };
+      if (pthread_create (&rs[i].thread, NULL, read_keys, &rs[i]))
+        {
+          abort ();
+        }
+    }
+  long found = 0, missed = 0;
+  for (int i = 0; i < readers; i++)
+    {
+      pthread_join (rs[i].thread, NULL);
+      found += rs[i].found;
+      missed += rs[i].missed;
+    }
+  double secs = wall_seconds () - start;
+  atomic_store (&s.done, true);
+  void *writes = 0;
+  if (writer)
+    {
+      pthread_join (w, &writes);
+    }
+
+  printf ("%-6s %d reader%s%s: %.2f M lookups/s, %ld found, %ld writes%s\n", locked ? "mutex" : "cstree", readers,
+          readers > 1 ? "s" : " ", writer ? " + writer" : "", readers * m / secs / 1e6, found, (long)writes,
+          missed ? " (EVEN KEYS MISSED)" : "");
+  free (rs);
+  free_cstree (s.ctree);
+  pthread_mutex_destroy (&s.lock);
+}
+
+// --------------- Main ---------------------------------------------------------- //
+
+// Compares lookups under one mutex with seqlock lookups in a cstree, for 1 to 8 reader threads. The threads run at
+// the same time, so the rate is measured in wall clock time; it only scales on as many cores.
+// Build with `make CFLAGS=-O2`, then run `./14_8_concurrent-tree 1000000`.
+int
+main (int argc, char *argv[])
+{
+  long n = argc > 1 ? atol (argv[1]) : 1000;
+  long m = argc > 1 ? n : 100000;
+  for (int readers = 1; readers <= (argc > 1 ? 8 : 2); readers *= 2)
+    {
+      for (int writer = 0; writer < 2; writer++)
+        {
+          run (true, readers, writer, n, m);
+          run (false, readers, writer, n, m);
+        }
+    }
+}
@@ -0,0 +1,255 @@
+#include "cstree.h"
+#include <sched.h>
+#include <stdlib.h>
+
+// Removed nodes are collected and freed in batches.
+#define RECLAIM_BATCH 64
+
+// Reader ids are 0 … readers - 1; NULL if `readers` isn't positive or there is no memory.
+cstree *
+new_cstree (stree_api api, bool balanced, int readers)
+{
+  if (readers <= 0)
+    {
+      return NULL;
+    }
+  cstree *t = malloc (sizeof *t);
+  if (!t)
+    {
+      return NULL;
+    }
+  *t = (cstree){
+    .tree    = balanced ? new_balanced_tree (api) : new_tree (api),
+    .readers = readers,
+    .slots   = aligned_alloc (sizeof (reader_slot), readers * sizeof (reader_slot)),
+  };
+  if (!t->tree || !t->slots)
+    {
+      if (t->tree)
+        {
+          free_tree (t->tree);
+        }
+      free (t->slots);
+      free (t);
+      return NULL;
+    }
+  pthread_mutex_init (&t->write_lock, NULL);
+  atomic_init (&t->seq, 0);
+  atomic_init (&t->epoch, 0);
+  for (int i = 0; i < readers; i++)
+    {
+      atomic_init (&t->slots[i].state, 0);
+    }
+  return t;
+}
+
+static void
+free_removed (cstree *t, node *n)
+{
+  if (t->tree->api.free)
+    {
+      t->tree->api.free (n);
+    }
+}
+
+// No reader may be inside any more.
+void
+free_cstree (cstree *t)
+{
+  for (size_t i = 0; i < t->n_retired; i++)
+    {
+      free_removed (t, t->retired[i].node);
+    }
+  free (t->retired);
+  free_tree (t->tree);
+  free (t->slots);
+  pthread_mutex_destroy (&t->write_lock);
+  free (t);
+}
+
+void
+cstree_read_lock (cstree *t, int reader)
+{
+  unsigned long epoch;
+  do
+    { // if the epoch moved on before we were seen, announce the new one
+      epoch = atomic_load (&t->epoch);
+      atomic_store (&t->slots[reader].state, epoch << 1 | 1);
+    }
+  while (atomic_load (&t->epoch) != epoch);
+}
+
+void
+cstree_read_unlock (cstree *t, int reader)
+{
+  atomic_store_explicit (&t->slots[reader].state, 0, memory_order_release);
+}
+
+// find_node(), with the child pointers read atomically while the writer changes them. The acquire loads pair with the
+// release stores of set_child() in stree.c, so the key of a node just linked in is seen as well.
+static node *
+find_racy (stree *t, void const *key)
+{
+  node *n = __atomic_load_n (&t->root.left, __ATOMIC_ACQUIRE);
+  while (n)
+    {
+      int cmp_res = t->api.cmp (key, t->api.key (n));
+      if (cmp_res == 0)
+        {
+          return n;
+        }
+      n = __atomic_load_n (cmp_res < 0 ? &n->left : &n->right, __ATOMIC_ACQUIRE);
+    }
+  return NULL;
+}
+
+// Call between cstree_read_lock() and cstree_read_unlock().
+node *
+cstree_find (cstree *t, void const *key)
+{
+  for (;;)
+    {
+      unsigned long seq = atomic_load_explicit (&t->seq, memory_order_acquire);
+      if (seq & 1)
+        {
+          sched_yield (); // a write is in progress
+          continue;
+        }
+      node *n = find_racy (t->tree, key);
+      atomic_thread_fence (memory_order_acquire);
+      if (atomic_load_explicit (&t->seq, memory_order_relaxed) == seq)
+        {
+          return n;
+        }
+    }
+}
+
+bool
+cstree_contains (cstree *t, int reader, void const *key)
+{
+  cstree_read_lock (t, reader);
+  bool found = cstree_find (t, key);
+  cstree_read_unlock (t, reader);
+  return found;
+}
+
+static void
+begin_write (cstree *t)
+{
+  pthread_mutex_lock (&t->write_lock);
+  atomic_fetch_add_explicit (&t->seq, 1, memory_order_relaxed);
+  atomic_thread_fence (memory_order_release); // the odd number is seen before any change of the tree
+}
+
+static void
+end_write (cstree *t)
+{
+  atomic_fetch_add_explicit (&t->seq, 1, memory_order_release);
+}
+
+// Moves the epoch on if every reader inside has seen the current one.
+static bool
+try_advance (cstree *t)
+{
+  unsigned long epoch = atomic_load (&t->epoch);
+  for (int i = 0; i < t->readers; i++)
+    {
+      unsigned long state = atomic_load (&t->slots[i].state);
+      if ((state & 1) && state >> 1 != epoch)
+        {
+          return false;
+        }
+    }
+  atomic_store (&t->epoch, epoch + 1);
+  return true;
+}
+
+// Frees the removed nodes that no reader can reach any more.
+static void
+reclaim (cstree *t)
+{
+  try_advance (t);
+  unsigned long epoch = atomic_load (&t->epoch);
+  size_t        kept  = 0;
+  for (size_t i = 0; i < t->n_retired; i++)
+    {
+      if (t->retired[i].epoch + 2 <= epoch)
+        {
+          free_removed (t, t->retired[i].node);
+        }
+      else
+        {
+          t->retired[kept++] = t->retired[i];
+        }
+    }
+  t->n_retired = kept;
+}
+
+// Frees `n` once no reader can reach it. If there is no memory to keep it on the list, waits for the readers.
+static void
+retire (cstree *t, node *n)
+{
+  if (t->n_retired == t->cap_retired)
+    {
+      size_t   cap    = t->cap_retired ? 2 * t->cap_retired : RECLAIM_BATCH;
+      retired *larger = realloc (t->retired, cap * sizeof *larger);
+      if (!larger)
+        {
+          unsigned long epoch = atomic_load (&t->epoch);
+          while (atomic_load (&t->epoch) < epoch + 2)
+            {
+              if (!try_advance (t))
+                {
+                  sched_yield ();
+                }
+            }
+          free_removed (t, n);
+          return;
+        }
+      t->retired     = larger;
+      t->cap_retired = cap;
+    }
+  t->retired[t->n_retired++] = (retired){ .node = n, .epoch = atomic_load (&t->epoch) };
+  if (t->n_retired >= RECLAIM_BATCH)
+    {
+      reclaim (t);
+    }
+}
+
+// Inserts `n`; a node with the same key is replaced, and freed once no reader can reach it.
+void
+cstree_insert (cstree *t, node *n)
+{
+  begin_write (t);
+  node *old = find_node (t->tree, t->tree->api.key (n));
+  if (old)
+    {
+      remove_node (old);
+    }
+  insert_node (t->tree, n);
+  end_write (t);
+  if (old)
+    {
+      retire (t, old);
+    }
+  pthread_mutex_unlock (&t->write_lock);
+}
+
+// Removes the node with `key`, and frees it once no reader can reach it. Returns false if there is none.
+bool
+cstree_delete (cstree *t, void const *key)
+{
+  begin_write (t);
+  node *n = find_node (t->tree, key);
+  if (n)
+    {
+      remove_node (n);
+    }
+  end_write (t);
+  if (n)
+    {
+      retire (t, n);
+    }
+  pthread_mutex_unlock (&t->write_lock);
+  return n;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "stree.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// A concurrent stree: any number of readers and one writer at a time.
+//
+// Readers don't take the mutex: a lookup is the read side of a seqlock. It walks the tree as find_node() does and then
+// checks a sequence number that each write increments twice (odd while the write is in progress); if a write
+// overlapped the walk, which may then have been misled by a rotation, the lookup starts over. Readers don't block each
+// other or the writer, but a lookup waits while a write is in progress, so a stalled writer holds up every reader.
+// Writers are serialized by a mutex. stree.c stores child pointers with release semantics (set_child()), which the
+// readers' acquire loads pair with.
+//
+// A reader can still stand on a node that a writer has just removed, so removed nodes aren't freed right away
+// (epoch-based reclamation): a reader announces the global epoch in its slot in cstree_read_lock() and leaves in
+// cstree_read_unlock(). The writer puts removed nodes on a list, with the epoch at that time, and advances the epoch
+// once all readers inside have seen the current one. A node is freed two epochs after its removal: by then every
+// reader that could have reached it has left.
+//
+// Each reader thread uses its own slot, 0 … readers - 1. A node returned by cstree_find() stays valid until the
+// reader calls cstree_read_unlock(). The keys must not change while a node is in the tree.
+
+typedef struct retired
+{
+  node         *node;
+  unsigned long epoch;
+} retired;
+
+// One cache line per reader, so that readers don't slow each other down by writing to the same line.
+typedef struct reader_slot
+{
+  atomic_ulong state; // the reader's epoch << 1 | 1 while it is inside, 0 outside
+  char         pad[64 - sizeof (atomic_ulong)];
+} reader_slot;
+
+typedef struct cstree
+{
+  stree          *tree;
+  pthread_mutex_t write_lock;
+  atomic_ulong    seq;   // odd while a write is in progress
+  atomic_ulong    epoch; // global epoch
+  int             readers;
+  reader_slot    *slots;
+  retired        *retired; // removed nodes that can't be freed yet
+  size_t          n_retired;
+  size_t          cap_retired;
+} cstree;
+
+cstree *new_cstree (stree_api api, bool balanced, int readers);
+void    free_cstree (cstree *t);
+void    cstree_read_lock (cstree *t, int reader);
+void    cstree_read_unlock (cstree *t, int reader);
+node   *cstree_find (cstree *t, void const *key);
+bool    cstree_contains (cstree *t, int reader, void const *key);
+void    cstree_insert (cstree *t, node *n);
+bool    cstree_delete (cstree *t, void const *key);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "list.h"
+#include <stddef.h>
+#include <stdio.h>
+
+// Generated list algorithms, for lists of one concrete container type.
+// The functions in list.c call `free`, `print` and the predicates through function pointers, once per link, so the
+// compiler can't inline them. The macros below generate the same algorithms for a container type `TYPE` that holds
+// its `link` in member `MEMBER`, with the free and print functions and the predicates known at compile time (as
+// GEN_DYNARRAY_IMPLEMENTATIONS in 10_Generic_Dynamic_Arrays does for arrays). The lists are the lists from list.h;
+// their `list_api` isn't used by the generated functions.
+//
+// FREE and PRINT take a `TYPE *`; PRED takes a `TYPE *` and returns a bool. Each can be a function or a macro.
+//
+// GEN_LIST(NAME, TYPE, MEMBER, FREE, PRINT) generates
+//   TYPE *NAME_item (link *lnk)               the container of a link
+//   void  NAME_free_list (list *lst)          frees the list and its items with FREE
+//   void  NAME_print_list (list *lst)
+// GEN_LIST_PREDICATE(NAME, TYPE, PRED) generates
+//   TYPE *NAME_find_PRED (list *lst, link *from)
+//   void  NAME_delete_if_PRED (list *lst)
+//   void  NAME_delete_if_PRED_into (list *lst, list *removed)
+
+#ifndef container
+#define container(p, type, member) ((type *)((char *)p - offsetof (type, member)))
+#endif
+
+#define GEN_LIST(NAME, TYPE, MEMBER, FREE, PRINT)                                                                      \
+  static inline TYPE *NAME##_item (link *lnk) { return container (lnk, TYPE, MEMBER); }                                \
+                                                                                                                       \
+  static inline void NAME##_free_item (TYPE *item) { FREE (item); }                                                    \
+                                                                                                                       \
+  static inline void NAME##_free_list (list *lst)                                                                      \
+  {                                                                                                                    \
+    link *lnk = front (lst);                                                                                           \
+    while (lnk != head (lst))                                                                                          \
+      {                                                                                                                \
+        link *next = lnk->next;                                                                                        \
+        NAME##_free_item (NAME##_item (lnk));                                                                          \
+        lnk = next;                                                                                                    \
+      }                                                                                                                \
+    free (lst);                                                                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline void NAME##_print_list (list *lst)                                                                     \
+  {                                                                                                                    \
+    printf ("[ ");                                                                                                     \
+    for (link *lnk = front (lst); lnk != head (lst); lnk = lnk->next)                                                  \
+      {                                                                                                                \
+        PRINT (NAME##_item (lnk));                                                                                     \
+        putchar (' ');                                                                                                 \
+      }                                                                                                                \
+    printf ("]\n");                                                                                                    \
+  }
+
+#define GEN_LIST_PREDICATE(NAME, TYPE, PRED)                                                                           \
+  static inline TYPE *NAME##_find_##PRED (list *lst, link *from)                                                       \
+  {                                                                                                                    \
+    for (link *lnk = from; lnk != head (lst); lnk = lnk->next)                                                         \
+      {                                                                                                                \
+        if (PRED (NAME##_item (lnk)))                                                                                  \
+          {                                                                                                            \
+            return NAME##_item (lnk);                                                                                  \
+          }                                                                                                            \
+      }                                                                                                                \
+    return NULL;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline void NAME##_delete_if_##PRED (list *lst)                                                               \
+  {                                                                                                                    \
+    link *lnk = front (lst);                                                                                           \
+    while (lnk != head (lst))                                                                                          \
+      {                                                                                                                \
+        link *next = lnk->next;                                                                                        \
+        if (PRED (NAME##_item (lnk)))                                                                                  \
+          {                                                                                                            \
+            unlink (lnk);                                                                                              \
+            NAME##_free_item (NAME##_item (lnk));                                                                      \
+          }                                                                                                            \
+        lnk = next;                                                                                                    \
+      }                                                                                                                \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline void NAME##_delete_if_##PRED##_into (list *lst, list *removed)                                         \
+  {                                                                                                                    \
+    link *lnk = front (lst);                                                                                           \
+    while (lnk != head (lst))                                                                                          \
+      {                                                                                                                \
+        if (!PRED (NAME##_item (lnk)))                                                                                 \
+          {                                                                                                            \
+            lnk = lnk->next;                                                                                           \
+            continue;                                                                                                  \
+          }                                                                                                            \
+        link *last = lnk; /* neighbouring matches are moved as one range, as in delete_if_into() */                    \
+        link *next;                                                                                                    \
+        while ((next = last->next) != head (lst) && PRED (NAME##_item (next)))                                         \
+          {                                                                                                            \
+            last = next;                                                                                               \
+          }                                                                                                            \
+        list_splice (removed, NULL, lnk, last);                                                                        \
+        lnk = (next == head (lst)) ? next : next->next; /* `next` is known not to match */                             \
+      }                                                                                                                \
+  }
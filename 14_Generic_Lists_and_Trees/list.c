@@ -84,3 +84,66 @@ delete_if (list *lst, pred_fn pred_fn)
       lnk = next;
     }
 }
+
+// Like delete_if(), but the links are moved to the back of `removed` (in list order) instead of being freed.
+// Neighbouring links that match are moved together, as one range.
+void
+delete_if_into (list *lst, pred_fn pred_fn, list *removed)
+{
+  link *lnk = front (lst);
+  while (lnk != head (lst))
+    {
+      if (!pred_fn (lnk))
+        {
+          lnk = lnk->next;
+          continue;
+        }
+      link *last = lnk;
+      link *next;
+      while ((next = last->next) != head (lst) && pred_fn (next))
+        {
+          last = next;
+        }
+      list_splice (removed, NULL, lnk, last);
+      lnk = (next == head (lst)) ? next : next->next; // `next` is known not to match
+    }
+}
+
+// Moves the links `first` … `last` (a range of one list, in list order) right after `pos` in `dst`, or to the back
+// of `dst` if `pos` is NULL; O(1). The range may come from any list, `dst` included, but `pos` must not be one of its
+// links other than `last`. A range already in place, e.g. the tail of `dst` with `pos` NULL, is left alone.
+void
+list_splice (list *dst, link *pos, link *first, link *last)
+{
+  if (!pos)
+    {
+      pos = back (dst);
+    }
+  if (pos == last || pos == first->prev)
+    {
+      return; // already in place
+    }
+  connect (first->prev, last->next); // close the gap
+  connect (last, pos->next);
+  connect (pos, first);
+}
+
+// Moves all links of `y` to the back of `x`, leaving `y` empty; O(1).
+void
+list_concatenate (list *x, list *y)
+{
+  if (!is_empty (y))
+    {
+      list_splice (x, NULL, front (y), back (y));
+    }
+}
+
+// Moves `at` and all links after it to the back of `rest`; O(1).
+void
+list_split_at (list *lst, link *at, list *rest)
+{
+  if (at != head (lst))
+    {
+      list_splice (rest, NULL, at, back (lst));
+    }
+}
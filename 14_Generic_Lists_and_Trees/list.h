@@ -31,6 +31,12 @@ void  free_list (list *lst);
 void  print_list (list *lst);
 link *find_link (list *lst, link *from, pred_fn pred_fn);
 void  delete_if (list *lst, pred_fn pred_fn);
+void  delete_if_into (list *lst, pred_fn pred_fn, list *removed);
+// `pos` NULL means the back of `dst`, and that implicit `pos` must not fall inside the range either, except as its
+// last link (a tail of `dst` stays where it is).
+void  list_splice (list *dst, link *pos, link *first, link *last);
+void  list_concatenate (list *x, list *y);
+void  list_split_at (list *lst, link *at, list *rest);
 
 // connect `x` to `y` (x ↔ y)
 static inline void
@@ -6,9 +6,84 @@
 // `t` is of type `stree*`; returns bool
 #define empty_tree(t) ((t)->root.left == NULL)
 
+// Tags in the low bits of `parent`. Nodes are at least 4-byte aligned, so these bits of a node pointer are 0.
+// BALANCED marks a node of a balanced tree, so remove_node() knows whether to rebalance. The dummy root has no tags;
+// it counts as black.
+#define RED      ((uintptr_t)1)
+#define BALANCED ((uintptr_t)2)
+#define TAGS     (RED | BALANCED)
+
+#define tags(n)          ((uintptr_t)(n)->parent & TAGS)
+#define is_red(n)        ((n) && ((uintptr_t)(n)->parent & RED))
+#define is_balanced(n)   ((uintptr_t)(n)->parent & BALANCED)
+#define set_red(n)       ((n)->parent = (node *)((uintptr_t)(n)->parent | RED))
+#define set_black(n)     ((n)->parent = (node *)((uintptr_t)(n)->parent & ~RED))
+#define set_parent(n, p) ((n)->parent = (node *)((uintptr_t)(p) | tags (n)))
+
+// Readers of a cstree (cstree.c) walk `left` and `right` while the writer changes them. So every store to a child
+// pointer that such a reader can reach is atomic, and a release: a node is complete, key and all, before a reader can
+// get to it.
+#define set_child(slot, n) __atomic_store_n ((slot), (n), __ATOMIC_RELEASE)
+
+// The left or right pointer of the parent of `n` that points to `n`.
+static inline node **
+slot (node *n)
+{
+  node *p = node_parent (n);
+  return n == p->left ? &p->left : &p->right;
+}
+
+#define size_of(n) ((n) ? (n)->size : 0)
+
+// Adds `d` to the sizes of `n` and its ancestors, up to the real root.
+static void
+add_to_sizes (node *n, long d)
+{
+  for (; node_parent (n); n = node_parent (n)) // stops at the dummy root
+    {
+      n->size += d;
+    }
+}
+
+// Rotates `x` down to the left; its right child `y` takes its place:
+//   (a x (b y c))  →  ((a x b) y c)
+static void
+rotate_left (node *x)
+{
+  node *y = x->right;
+  set_child (&x->right, y->left);
+  if (y->left)
+    {
+      set_parent (y->left, x);
+    }
+  set_child (slot (x), y);
+  set_parent (y, node_parent (x));
+  set_child (&y->left, x);
+  set_parent (x, y);
+  y->size = x->size;
+  x->size = size_of (x->left) + size_of (x->right) + 1;
+}
+
+static void
+rotate_right (node *x)
+{
+  node *y = x->left;
+  set_child (&x->left, y->right);
+  if (y->right)
+    {
+      set_parent (y->right, x);
+    }
+  set_child (slot (x), y);
+  set_parent (y, node_parent (x));
+  set_child (&y->right, x);
+  set_parent (x, y);
+  y->size = x->size;
+  x->size = size_of (x->left) + size_of (x->right) + 1;
+}
+
 // To create a new tree `key` and `cmp` functions are necessary.
-stree *
-new_tree (stree_api api)
+static stree *
+new_tree_with (stree_api api, bool balanced)
 {
   if (!(api.key && api.cmp))
     {
@@ -23,13 +98,26 @@ new_tree (stree_api api)
         .right  = NULL,
       };
       *tree = (stree){
-        .root = root,
-        .api  = api,
+        .root     = root,
+        .api      = api,
+        .balanced = balanced,
       };
     }
   return tree;
 }
 
+stree *
+new_tree (stree_api api)
+{
+  return new_tree_with (api, false);
+}
+
+stree *
+new_balanced_tree (stree_api api)
+{
+  return new_tree_with (api, true);
+}
+
 static void
 free_nodes_rec (free_node_fn free, node *n)
 {
@@ -39,6 +127,7 @@ free_nodes_rec (free_node_fn free, node *n)
     }
   free_nodes_rec (free, n->left);
   free_nodes_rec (free, n->right);
+  n->left = n->right = n->parent = NULL; // so that remove_node() in `free` doesn't touch the (freed) tree
   if (free)
     {
       free (n);
@@ -92,6 +181,149 @@ find_node (stree *t, void const *key)
   return *find_loc (t, key, real_tree, &parent);
 }
 
+size_t
+stree_size (stree *t)
+{
+  return size_of (t->root.left);
+}
+
+// The node with the k-th smallest key, counting from 0; NULL if there are no more than k nodes.
+node *
+stree_select (stree *t, size_t k)
+{
+  node *n = t->root.left;
+  while (n)
+    {
+      size_t left = size_of (n->left);
+      if (k == left)
+        {
+          return n;
+        }
+      if (k < left)
+        {
+          n = n->left;
+        }
+      else
+        {
+          k -= left + 1;
+          n = n->right;
+        }
+    }
+  return NULL;
+}
+
+// Number of keys smaller than `key`, or not larger if `inclusive`.
+static size_t
+count_below (stree *t, void const *key, bool inclusive)
+{
+  size_t count = 0;
+  node  *n     = t->root.left;
+  while (n)
+    {
+      int cmp_res = t->api.cmp (key, t->api.key (n));
+      if (cmp_res < 0 || (cmp_res == 0 && !inclusive))
+        {
+          n = n->left;
+        }
+      else
+        {
+          count += size_of (n->left) + 1;
+          n = n->right;
+        }
+    }
+  return count;
+}
+
+// Number of keys smaller than `key`; the index of `key` if it is in the tree.
+size_t
+stree_rank (stree *t, void const *key)
+{
+  return count_below (t, key, false);
+}
+
+// Number of keys in [lo, hi].
+size_t
+stree_count_range (stree *t, void const *lo, void const *hi)
+{
+  size_t below_hi = count_below (t, hi, true);
+  size_t below_lo = count_below (t, lo, false);
+  return below_hi > below_lo ? below_hi - below_lo : 0;
+}
+
+// `new` takes the place (and colour) of `old` in the tree; `old` is left detached.
+static void
+replace_node (node *old, node *new)
+{
+  set_child (&new->left, old->left);
+  set_child (&new->right, old->right);
+  new->size = old->size;
+  set_child (slot (old), new);
+  new->parent = old->parent;
+  if (new->left)
+    {
+      set_parent (new->left, new);
+    }
+  if (new->right)
+    {
+      set_parent (new->right, new);
+    }
+  set_child (&old->left, NULL);
+  set_child (&old->right, NULL);
+  old->parent = NULL;
+}
+
+// Restores the red-black properties after the red node `n` was added as a leaf: no red node has a red parent.
+static void
+fix_after_insert (node *n)
+{
+  node *p;
+  while (is_red (p = node_parent (n)))
+    {
+      node *g = node_parent (p); // p is red, so it isn't the root, and g is a real node
+      if (p == g->left)
+        {
+          node *u = g->right;
+          if (is_red (u))
+            {
+              set_black (p);
+              set_black (u);
+              set_red (g);
+              n = g;
+              continue;
+            }
+          if (n == p->right)
+            {
+              rotate_left (p);
+              p = n;
+            }
+          set_black (p);
+          set_red (g);
+          rotate_right (g);
+        }
+      else
+        {
+          node *u = g->left;
+          if (is_red (u))
+            {
+              set_black (p);
+              set_black (u);
+              set_red (g);
+              n = g;
+              continue;
+            }
+          if (n == p->left)
+            {
+              rotate_right (p);
+              p = n;
+            }
+          set_black (p);
+          set_red (g);
+          rotate_left (g);
+        }
+      break;
+    }
+}
+
 void
 insert_node (stree *t, node *n)
 {
@@ -100,12 +332,25 @@ insert_node (stree *t, node *n)
   void const *key       = t->api.key (n);
   node      **target    = find_loc (t, key, real_tree, &parent);
   if (*target)
-    {
-      delete_node (t, *target);
+    { // same key: `n` replaces the old node
+      node *old = *target;
+      replace_node (old, n);
+      if (t->api.free)
+        {
+          t->api.free (old);
+        }
+      return;
     }
-  *target   = n;             // TODO: what is this good for? It's superfluous.
-  n->parent = parent;
   n->left = n->right = NULL; // makes the node a leaf
+  n->parent          = t->balanced ? (node *)((uintptr_t)parent | BALANCED | RED) : parent;
+  n->size            = 0;
+  set_child (target, n);
+  add_to_sizes (n, 1);
+  if (t->balanced)
+    {
+      fix_after_insert (n);
+      set_black (t->root.left);
+    }
 }
 
 node **
@@ -119,40 +364,119 @@ rightmost (node **n, node **parent)
   return n;
 }
 
+// Restores the red-black properties before the black leaf `x` is removed: every path from the root down to a leaf
+// has the same number of black nodes, and paths through `x` are about to lose one.
+static void
+fix_before_remove (node *x)
+{
+  node *p;
+  while (!is_red (x) && node_parent (p = node_parent (x))) // x is black and not the root
+    {
+      if (x == p->left)
+        {
+          node *s = p->right; // x is black, so it has a sibling
+          if (is_red (s))
+            {
+              set_black (s);
+              set_red (p);
+              rotate_left (p);
+              s = p->right;
+            }
+          if (!is_red (s->left) && !is_red (s->right))
+            {
+              set_red (s);
+              x = p;
+              continue;
+            }
+          if (!is_red (s->right))
+            {
+              set_black (s->left);
+              set_red (s);
+              rotate_right (s);
+              s = p->right;
+            }
+          is_red (p) ? set_red (s) : set_black (s);
+          set_black (p);
+          set_black (s->right);
+          rotate_left (p);
+        }
+      else
+        {
+          node *s = p->left;
+          if (is_red (s))
+            {
+              set_black (s);
+              set_red (p);
+              rotate_right (p);
+              s = p->left;
+            }
+          if (!is_red (s->left) && !is_red (s->right))
+            {
+              set_red (s);
+              x = p;
+              continue;
+            }
+          if (!is_red (s->left))
+            {
+              set_black (s->right);
+              set_red (s);
+              rotate_left (s);
+              s = p->left;
+            }
+          is_red (p) ? set_red (s) : set_black (s);
+          set_black (p);
+          set_black (s->left);
+          rotate_right (p);
+        }
+      return;
+    }
+  set_black (x);
+}
+
 void
 remove_node (node *n)
 {
-  // dummy root has no parent
-  if (!n->parent)
+  // dummy root has no parent; neither has a removed node
+  if (!node_parent (n))
     {
       return;
     }
 
-  // Get the location to replace. Address of left or right pointer of parent.
-  node **loc = (n == n->parent->left) ? &n->parent->left : &n->parent->right;
+  // The node that is taken out of its place: `n`, or if both children are set, the rightmost node of the left tree
+  // (which then takes the place of `n`). Either way, `out` has at most one child.
+  node *out = n;
+  if (n->left && n->right)
+    {
+      node *rm_parent = n;
+      out             = *rightmost (&n->left, &rm_parent);
+    }
+  node *child = out->left ? out->left : out->right;
 
-  if (!(n->left && n->right))
-    { // node has at least one empty child...
-      *loc = n->left ? n->left : n->right;
-      if (*loc)
+  if (is_balanced (n) && !is_red (out))
+    { // a black node is taken out
+      if (child)
         {
-          (*loc)->parent = n->parent; // could be that both children are emtpy
+          set_black (child); // child is red
         }
-    }
-  else
-    { // both children are set; replace node with rightmost child of left tree
-      node  *rm_parent = n;
-      node **rm_ref    = rightmost (&n->left, &rm_parent);
-      node  *rm        = *rm_ref;
-      *rm_ref          = rm->left;
-      if (*rm_ref)
+      else
         {
-          (*rm_ref)->parent = rm_parent; // set parent of left of rightmost - if existing - to rightmost's parent
+          fix_before_remove (out);
         }
-      *loc = rm;
-      *rm  = *n;
     }
-  n->left = n->right = n->parent = NULL;
+  add_to_sizes (out, -1); // `out` itself goes, and its size isn't needed any more
+
+  set_child (slot (out), child);
+  if (child)
+    {
+      set_parent (child, node_parent (out));
+    }
+  if (out != n)
+    {
+      replace_node (n, out);
+    }
+  set_child (&n->left, NULL);
+  set_child (&n->right, NULL);
+  n->parent = NULL;
 }
 
 void
@@ -1,14 +1,24 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct node
 {
+  // The two low bits of `parent` are tags (the colour of the node in a balanced tree); use node_parent().
   struct node *parent;
   struct node *left;
   struct node *right;
+  size_t       size; // number of nodes in the subtree
 } node;
 
+static inline node *
+node_parent (node *n)
+{
+  return (node *)((uintptr_t)n->parent & ~(uintptr_t)3);
+}
+
 typedef void const *(*key_node_fn) (node *n);
 typedef int         (*cmp_nodes_fn) (void const *x, void const *y);
 typedef void        (*print_node_fn) (node *n);
@@ -29,12 +39,19 @@ typedef struct stree
   // Real tree starts with left child of `root`.
   node      root;
   stree_api api;
+  // A balanced tree is a red-black tree; insert_node and remove_node keep its height below 2 log2(n + 1).
+  bool      balanced;
 } stree;
 
 void   remove_node (node *n);
 void   delete_node (stree *t, node *n);
 void   insert_node (stree *t, node *n);
 node  *find_node (stree *t, void const *key);
+size_t stree_size (stree *t);
+node  *stree_select (stree *t, size_t k);
+size_t stree_rank (stree *t, void const *key);
+size_t stree_count_range (stree *t, void const *lo, void const *hi);
 stree *new_tree (stree_api api);
+stree *new_balanced_tree (stree_api api);
 void   print_tree (stree *t);
 void   free_tree (stree *t);
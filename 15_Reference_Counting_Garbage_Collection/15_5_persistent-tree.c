@@ -0,0 +1,557 @@
+#include "refcount.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The immutable trees of 15_4_strees.c, kept balanced: a weight-balanced tree (Adams; the parameters are those of
+// Hirai and Yamamoto, "Balancing weight-balanced trees"). Each node knows the size of its subtree, and the two
+// subtrees of a node never weigh more than DELTA times each other (weight = size + 1). An insert or a delete copies the
+// path to the value, O(log n) nodes, and rebalances the copies with at most one single or double rotation per level.
+// Everything off the path is shared with the old version through incref, so a version is just a root: taking a
+// snapshot is an incref, O(1), and the old version stays valid until its last reference is gone.
+
+#define DELTA 3
+#define GAMMA 2
+
+// immutable tree (consisting of immutable nodes)
+typedef struct node
+{
+  int const          val; // first, as in strees.h: refcount.c's print_stack() reads it
+  size_t const       size;
+  struct node *const left;
+  struct node *const right;
+} node;
+
+// `t` is of type `node*`
+#define EMPTY       incref (empty_node)
+#define is_empty(t) (t == empty_node)
+#define is_error(t) (t == NULL)
+
+node *empty_node;
+
+void
+init_empty_node (void)
+{
+  if (empty_node)
+    {
+      return;
+    }
+
+  empty_node = rc_alloc (sizeof *empty_node, NULL);
+  if (!empty_node)
+    {
+      abort ();
+    }
+  memcpy (empty_node,
+          &(node){
+              .val   = 314159,
+              .size  = 0,
+              .left  = NULL,
+              .right = NULL,
+          },
+          sizeof *empty_node);
+}
+
+// counting number of nodes
+size_t n_nodes;
+
+// `cleanup_fn` function for a node.
+void
+free_node (void *p, void *ctx)
+{
+  n_nodes--;
+  node *n = p;
+  decref_ctx (n->left, ctx);
+  decref_ctx (n->right, ctx);
+}
+
+#define weight(t) ((t)->size + 1)
+
+node *
+new_node (int val, takes node *left, takes node *right)
+{
+  if (is_error (left) || is_error (right))
+    {
+      goto error;
+    }
+
+  node *n = rc_alloc (sizeof *n, free_node);
+  if (!n)
+    {
+      goto error;
+    }
+  n_nodes++;
+  memcpy (n,
+          &(node){
+              .val   = val,
+              .size  = left->size + 1 + right->size,
+              .left  = give (left),
+              .right = give (right),
+          },
+          sizeof *n);
+  return n;
+
+error:
+  decref (left);
+  decref (right);
+  return NULL;
+}
+
+// O(1): the version stays as it is, whatever is done to `tree` later.
+node *
+snapshot (borrows node *tree)
+{
+  return incref (tree);
+}
+
+bool
+contains (borrows node *tree, int val)
+{
+  assert (!is_error (tree));
+  while (!is_empty (tree) && tree->val != val)
+    {
+      tree = val < tree->val ? tree->left : tree->right;
+    }
+  return !is_empty (tree);
+}
+
+// Builds the node (val, left, right) when `left` may have become too heavy (after an insert into it or a delete from
+// `right`).
+static node *
+balance_left (int val, takes node *left, takes node *right)
+{
+  if (is_error (left) || is_error (right))
+    {
+      decref (left);
+      decref (right);
+      return NULL;
+    }
+  if (weight (left) <= DELTA * weight (right))
+    {
+      return new_node (val, give (left), give (right));
+    }
+
+  int   lval = left->val;
+  node *ll   = incref (left->left);
+  node *lr   = incref (left->right);
+  decref (left);
+  if (weight (lr) < GAMMA * weight (ll))
+    { // single rotation to the right
+      return new_node (lval, give (ll), new_node (val, give (lr), give (right)));
+    }
+  // double rotation: lr's value goes to the top
+  int   lrval = lr->val;
+  node *lrl   = incref (lr->left);
+  node *lrr   = incref (lr->right);
+  decref (lr);
+  return new_node (lrval, new_node (lval, give (ll), give (lrl)), new_node (val, give (lrr), give (right)));
+}
+
+// The mirror image of balance_left().
+static node *
+balance_right (int val, takes node *left, takes node *right)
+{
+  if (is_error (left) || is_error (right))
+    {
+      decref (left);
+      decref (right);
+      return NULL;
+    }
+  if (weight (right) <= DELTA * weight (left))
+    {
+      return new_node (val, give (left), give (right));
+    }
+
+  int   rval = right->val;
+  node *rl   = incref (right->left);
+  node *rr   = incref (right->right);
+  decref (right);
+  if (weight (rl) < GAMMA * weight (rr))
+    { // single rotation to the left
+      return new_node (rval, new_node (val, give (left), give (rl)), give (rr));
+    }
+  // double rotation: rl's value goes to the top
+  int   rlval = rl->val;
+  node *rll   = incref (rl->left);
+  node *rlr   = incref (rl->right);
+  decref (rl);
+  return new_node (rlval, new_node (val, give (left), give (rll)), new_node (rval, give (rlr), give (rr)));
+}
+
+static node *
+insert_ (takes node *tree, int val)
+{
+  if (is_empty (tree))
+    {
+      decref (tree);
+      return new_node (val, EMPTY, EMPTY);
+    }
+
+  int   tval  = tree->val;
+  node *left  = incref (tree->left);
+  node *right = incref (tree->right);
+  decref (tree);
+  if (val < tval)
+    {
+      return balance_left (tval, insert_ (give (left), val), give (right));
+    }
+  else
+    {
+      return balance_right (tval, give (left), insert_ (give (right), val));
+    }
+}
+
+// If `val` is already there, `tree` is returned as it is: no path is copied, and the versions stay identical.
+node *
+insert (takes node *tree, int val)
+{
+  if (is_error (tree) || contains (tree, val))
+    {
+      return give (tree);
+    }
+  return insert_ (give (tree), val);
+}
+
+int
+leftmost_value (borrows node *tree)
+{
+  assert (!is_empty (tree));
+  while (!is_empty (tree->left))
+    {
+      tree = tree->left;
+    }
+  return tree->val;
+}
+
+int
+rightmost_value (borrows node *tree)
+{
+  assert (!is_empty (tree));
+  while (!is_empty (tree->right))
+    {
+      tree = tree->right;
+    }
+  return tree->val;
+}
+
+static node *
+delete_ (takes node *tree, int val)
+{
+  int   tval  = tree->val;
+  node *left  = incref (tree->left);
+  node *right = incref (tree->right);
+  decref (tree);
+
+  if (val < tval)
+    {
+      return balance_right (tval, delete_ (give (left), val), give (right));
+    }
+  else if (val > tval)
+    {
+      return balance_left (tval, give (left), delete_ (give (right), val));
+    }
+  else
+    {
+      if (is_empty (left))
+        {
+          decref (left);
+          return give (right);
+        }
+      if (is_empty (right))
+        {
+          decref (right);
+          return give (left);
+        }
+      // replace tval by its neighbour from the heavier side
+      if (left->size > right->size)
+        {
+          int rmval = rightmost_value (left);
+          return balance_right (rmval, delete_ (give (left), rmval), give (right));
+        }
+      int lmval = leftmost_value (right);
+      return balance_left (lmval, give (left), delete_ (give (right), lmval));
+    }
+}
+
+// If `val` isn't there, `tree` is returned as it is.
+node *delete (takes node *tree, int val)
+{
+  if (is_error (tree) || !contains (tree, val))
+    {
+      return give (tree);
+    }
+  return delete_ (give (tree), val);
+}
+
+// Walks the values of a tree in order. Entries are whole subtrees still to walk, or single nodes whose left subtree
+// is done. A weight-balanced tree of at most 2^32 values is at most log_{4/3} 2^32 < 78 high, and the stack holds at
+// most two entries per level, plus one.
+typedef struct walk
+{
+  int   top;
+  bool  whole[256];
+  node *nodes[256];
+} walk;
+
+static void
+push (walk *w, node *n, bool whole)
+{
+  if (!is_empty (n))
+    {
+      w->whole[w->top]   = whole;
+      w->nodes[w->top++] = n;
+    }
+}
+
+// Replaces the subtree on top by its left subtree, its node and its right subtree.
+static void
+expand (walk *w)
+{
+  node *n = w->nodes[--w->top];
+  push (w, n->right, true);
+  push (w, n, false);
+  push (w, n->left, true);
+}
+
+// Same values? Two versions that share a subtree at the same position skip it without looking inside, so comparing a
+// version with a snapshot it was derived from costs O(changes · log n), not O(n).
+bool
+equal (borrows node *a, borrows node *b)
+{
+  if (a == b)
+    {
+      return true;
+    }
+  if (a->size != b->size)
+    {
+      return false;
+    }
+
+  walk wa = { 0 }, wb = { 0 };
+  push (&wa, a, true);
+  push (&wb, b, true);
+  while (wa.top && wb.top) // the sizes are the same, so both end at once
+    {
+      int   i = wa.top - 1, j = wb.top - 1;
+      node *x = wa.nodes[i], *y = wb.nodes[j];
+      if (wa.whole[i] && wb.whole[j] && x == y)
+        { // the same subtree, with the same values before it
+          wa.top--;
+          wb.top--;
+        }
+      else if (wa.whole[i] && (!wb.whole[j] || x->size >= y->size))
+        { // open the larger subtree first: the smaller one may be shared with a part of it
+          expand (&wa);
+        }
+      else if (wb.whole[j])
+        {
+          expand (&wb);
+        }
+      else if (x->val != y->val)
+        {
+          return false;
+        }
+      else
+        {
+          wa.top--;
+          wb.top--;
+        }
+    }
+  return true;
+}
+
+// Checks sizes, order and balance; returns the size.
+size_t
+check_tree (borrows node *tree, long lo, long hi)
+{
+  if (is_empty (tree))
+    {
+      return 0;
+    }
+  assert (lo < tree->val && tree->val < hi);
+  size_t l = check_tree (tree->left, lo, tree->val);
+  size_t r = check_tree (tree->right, tree->val, hi);
+  assert (tree->size == l + 1 + r);
+  assert (l + 1 <= DELTA * (r + 1) && r + 1 <= DELTA * (l + 1));
+  return l + 1 + r;
+}
+
+int
+height (borrows node *tree)
+{
+  if (is_empty (tree))
+    {
+      return 0;
+    }
+  int l = height (tree->left);
+  int r = height (tree->right);
+  return 1 + (l > r ? l : r);
+}
+
+static void
+print_tree_ (borrows node *n)
+{
+  if (is_empty (n))
+    {
+      return;
+    }
+  putchar ('(');
+  print_tree_ (n->left);
+  printf (",%d[%zd],", n->val, (get_rc_struct (n))->rc);
+  print_tree_ (n->right);
+  putchar (')');
+}
+
+void
+print_tree (borrows node *n)
+{
+  print_tree_ (n);
+  putchar ('\n');
+}
+
+double
+seconds_since (clock_t start)
+{
+  return (double)(clock () - start) / CLOCKS_PER_SEC;
+}
+
+// Applies `n` random inserts and deletes to one tree, keeping a snapshot after every `n / versions` changes. Then
+// compares each snapshot with itself after inserting and deleting `n` (the same values, but a copied path), and the
+// last version with a copy built from scratch that shares nothing with it.
+// Build with `make CFLAGS=-O2\ -DNDEBUG` (refcount.c prints the cleanup stack otherwise), then run
+// `./15_5_persistent-tree 1000000`.
+void
+benchmark (int n, int versions)
+{
+  node **snapshots = malloc (versions * sizeof *snapshots);
+  if (!snapshots)
+    {
+      abort ();
+    }
+  srand (1);
+  node   *tree  = EMPTY;
+  clock_t start = clock ();
+  for (int v = 0; v < versions; v++)
+    {
+      for (int i = 0; i < n / versions; i++)
+        {
+          int val = rand () % n;
+          tree    = rand () % 4 ? insert (tree, val) : delete (tree, val);
+        }
+      snapshots[v] = snapshot (tree);
+    }
+  double t_changes = seconds_since (start);
+  if (is_error (tree))
+    {
+      abort ();
+    }
+  check_tree (tree, (long)INT_MIN - 1, (long)INT_MAX + 1);
+  printf ("%d changes, %d snapshots: %.3fs; %zu values, height %d, %zu nodes in all versions\n", n, versions,
+          t_changes, tree->size, height (tree), n_nodes);
+
+  node **redone = malloc (versions * sizeof *redone);
+  if (!redone)
+    {
+      abort ();
+    }
+  for (int v = 0; v < versions; v++)
+    {
+      redone[v] = delete (insert (snapshot (snapshots[v]), n), n);
+      if (is_error (redone[v]) || redone[v] == snapshots[v])
+        {
+          abort ();
+        }
+    }
+  int same = 0;
+  start    = clock ();
+  for (int v = 0; v < versions; v++)
+    {
+      same += equal (snapshots[v], redone[v]);
+    }
+  double t_shared = seconds_since (start);
+
+  node *copy = EMPTY;
+  for (int i = 0; i < versions; i++)
+    {
+      for (int j = i; j < n; j += versions) // a different order of inserts, so a different shape
+        {
+          if (contains (tree, j))
+            {
+              copy = insert (copy, j);
+            }
+        }
+    }
+  if (is_error (copy))
+    {
+      abort ();
+    }
+  start             = clock ();
+  bool   copy_equal = equal (tree, copy);
+  double t_copy     = seconds_since (start);
+  printf ("equal: %d snapshots with their redone path (%d the same) %.6fs; last version with a copy (%s) %.6fs\n",
+          versions, same, t_shared, copy_equal ? "the same" : "DIFFERENT", t_copy);
+
+  start = clock ();
+  decref (copy);
+  decref (tree);
+  for (int v = 0; v < versions; v++)
+    {
+      decref (snapshots[v]);
+      decref (redone[v]);
+    }
+  printf ("freeing all versions: %.3fs, %zu nodes left\n", seconds_since (start), n_nodes);
+  free (snapshots);
+  free (redone);
+}
+
+int
+main (int argc, char *argv[])
+{
+  init_empty_node ();
+
+  printf (" =============== Case 1 ===============\n");
+  printf ("    Inserting 1 … 7 in order: balanced.\n");
+  printf (" ======================================\n");
+  node *x = EMPTY;
+  for (int i = 1; i <= 7; i++)
+    {
+      x = insert (x, i);
+    }
+  print_tree (x);
+  printf ("%zu nodes.\n", n_nodes);
+
+  printf (" =============== Case 2 ===============\n");
+  printf ("    A snapshot, then changes to x.\n");
+  printf (" ======================================\n");
+  node *v1 = snapshot (x);
+  x        = insert (x, 8);
+  x        = delete (x, 2);
+  print_tree (v1);
+  print_tree (x);
+  printf ("%zu nodes (%zu + %zu without sharing).\n", n_nodes, v1->size, x->size);
+
+  printf (" =============== Case 3 ===============\n");
+  printf ("              Equality.\n");
+  printf (" ======================================\n");
+  node *y = insert (delete (snapshot (x), 8), 2); // v1's values again, in new nodes along the path
+  printf ("v1 == x: %d, v1 == x - 8 + 2: %d\n", equal (v1, x), equal (v1, y));
+  decref (y);
+
+  printf (" =============== Case 4 ===============\n");
+  printf ("            Cleaning up...\n");
+  printf (" ======================================\n");
+  decref (v1);
+  printf ("%zu nodes.\n", n_nodes);
+  decref (x);
+  printf ("%zu nodes.\n", n_nodes);
+
+  if (argc > 1)
+    {
+      int n = atoi (argv[1]);
+      benchmark (n, 1000);
+    }
+}
@@ -95,7 +95,9 @@ decref_ctx (void *p, void *prev_ctx)
           rc_struct *prev = prev_ctx;
           current->stack  = prev->stack; // push on stack marking for deletion
           prev->stack     = current;
+#ifndef NDEBUG
           print_stack (prev_ctx);
+#endif
         }
       return NULL;
     }